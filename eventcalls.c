@@ -4,11 +4,25 @@
 #include <linux/eventcalls.h>
 
 
-/* Event list head with eventID is 0 and is initilized during kernel boot. */
-struct event global_event;
-/* A read write lock on event list. */
-rwlock_t eventID_list_lock;
-/* A state indicating whether the global_event has been initialized successfully. */
+/*
+ * Table of events. An event ID selects a bucket, a slot within the bucket and a generation.
+ * Each bucket has its own lock, so opens and closes in different buckets never contend.
+ * Lookups index the slot directly under rcu_read_lock alone.
+ */
+struct event_bucket * event_table;
+unsigned int event_table_mask;
+unsigned int event_table_shift;
+/* Number of slots each bucket may grow to. */
+static unsigned int event_bucket_slots;
+/* Bucket count requested with the "eventbuckets=" boot parameter. */
+static unsigned int event_table_buckets = EVENT_TABLE_DEFAULT_BUCKETS;
+/* Slab cache of struct event, visible as "event" in /proc/slabinfo. */
+static struct kmem_cache * event_cachep;
+/* Free slots reserved by each CPU, so opens and closes mostly skip the bucket locks. */
+static DEFINE_PER_CPU(struct event_slot_cache, event_slot_cache);
+/* Longest time, in nanoseconds, an adaptive wait spins before sleeping. Set with the "eventspin=" boot parameter in microseconds. */
+static unsigned long event_spin_ns = EVENT_SPIN_DEFAULT_US * NSEC_PER_USEC;
+/* A state indicating whether the event table has been initialized successfully. */
 bool event_initialized;
 
 
@@ -16,9 +30,54 @@ bool event_initialized;
 
 
 
+/*
+ * Parse the "eventbuckets=" boot parameter.
+ * The value is rounded up to a power of two by doevent_init().
+ */
+static int __init event_table_buckets_setup(char * str)
+{
+    unsigned long buckets = simple_strtoul(str, NULL, 0);
+
+    if (buckets == 0 || buckets > EVENT_TABLE_MAX_BUCKETS) {
+        printk("error eventbuckets=: invalid bucket count %s\n", str);
+        return 0;
+    }
+
+    event_table_buckets = buckets;
+    return 1;
+}
+__setup("eventbuckets=", event_table_buckets_setup);
+
+
+
+
+
+
+/*
+ * Parse the "eventspin=" boot parameter, in microseconds. 0 disables adaptive spinning.
+ */
+static int __init event_spin_setup(char * str)
+{
+    unsigned long us = simple_strtoul(str, NULL, 0);
+
+    if (us > EVENT_SPIN_MAX_US) {
+        printk("error eventspin=: invalid spin time %s\n", str);
+        return 0;
+    }
+
+    event_spin_ns = us * NSEC_PER_USEC;
+    return 1;
+}
+__setup("eventspin=", event_spin_setup);
+
+
+
+
+
+
 /*
  * Return the length of the list with given list_head.
- * Remember to call read_lock before.
+ * Remember to lock the list before.
  */
 int get_list_length(struct list_head * head)
 {
@@ -41,28 +100,379 @@ int get_list_length(struct list_head * head)
 
 
 /*
- * Return a pointer to the event with given event ID.
+ * Build an event ID from its bucket index, slot index and generation.
+ */
+static inline int event_make_ID(unsigned int bucket, unsigned int slot, unsigned int generation)
+{
+    return (int) ((generation << EVENT_ID_INDEX_BITS) | (slot << event_table_shift) | bucket);
+}
+
+
+
+
+
+
+
+
+/*
+ * Return the index of the slot the given event ID refers to within its bucket.
+ */
+static inline unsigned int event_ID_slot(int eventID)
+{
+    return ((unsigned int) eventID & ((1 << EVENT_ID_INDEX_BITS) - 1)) >> event_table_shift;
+}
+
+
+
+
+
+
+
+
+/*
+ * Return the slot with the given index in the given bucket.
+ * Return NULL if the bucket has not grown that far.
+ * Remember to call rcu_read_lock or lock the bucket before.
+ */
+static struct event_slot * event_slot(struct event_bucket * bucket, unsigned int slot)
+{
+    if (slot >= event_bucket_slots) {
+        return (struct event_slot *) NULL;
+    }
+
+    struct event_slot * chunk = rcu_dereference(bucket->chunks[slot / EVENT_SLOT_CHUNK]);
+    if (chunk == NULL) {
+        return (struct event_slot *) NULL;
+    }
+
+    return &chunk[slot % EVENT_SLOT_CHUNK];
+}
+
+
+
+
+
+
+
+
+/*
+ * Return a pointer to the event with given event ID without taking a reference.
+ * Return NULL if the event with the given event ID is not found.
+ * Remember to call rcu_read_lock or lock the event's bucket before.
+ */
+static struct event * __get_event(int eventID)
+{
+    /* Event IDs are positive. */
+    if (eventID <= 0) {
+        return (struct event *) NULL;
+    }
+
+    struct event_bucket * bucket = &event_table[eventID & event_table_mask];
+    unsigned int slot = event_ID_slot(eventID);
+    struct event_slot * this_slot = event_slot(bucket, slot);
+    if (this_slot == NULL) {
+        return (struct event *) NULL;
+    }
+
+    /* A recycled slot holds an event of another generation, and thus another ID. */
+    struct event * this_event = rcu_dereference(this_slot->event);
+    if (this_event == NULL || this_event->eventID != eventID) {
+        return (struct event *) NULL;
+    }
+
+    return this_event;
+}
+
+
+
+
+
+
+
+
+/*
+ * Add a chunk of free slots to the head of the given bucket's free list, so fresh slots go before recycled ones.
+ * Return 0 on success.
+ * Return -1 if the bucket is full or memory is short.
+ * Called with the bucket locked. The lock is dropped and retaken to allocate.
+ */
+static int event_bucket_grow(struct event_bucket * bucket, unsigned long * flags)
+{
+    unsigned int first = bucket->nr_slots;
+    if (first >= event_bucket_slots) {
+        return -1;
+    }
+
+    spin_unlock_irqrestore(&(bucket->lock), *flags);
+    struct event_slot * chunk = kmalloc(EVENT_SLOT_CHUNK * sizeof(struct event_slot), GFP_KERNEL);
+    spin_lock_irqsave(&(bucket->lock), *flags);
+
+    if (chunk == NULL) {
+        printk("error event_bucket_grow(): kmalloc()\n");
+        return -1;
+    }
+
+    /* A racing open may have grown the bucket meanwhile. */
+    if (bucket->nr_slots != first) {
+        kfree(chunk);
+        return 0;
+    }
+
+    /* Link the new slots into the free list, lowest index first. */
+    unsigned int i;
+    for (i = 0; i < EVENT_SLOT_CHUNK; i++) {
+        chunk[i].event = NULL;
+        chunk[i].generation = 1;
+        chunk[i].next_free = (i + 1 < EVENT_SLOT_CHUNK) ? first + i + 1 : bucket->free_head;
+    }
+    rcu_assign_pointer(bucket->chunks[first / EVENT_SLOT_CHUNK], chunk);
+    if (bucket->free_head < 0) {
+        bucket->free_tail = first + EVENT_SLOT_CHUNK - 1;
+    }
+    bucket->free_head = first;
+    bucket->nr_free += EVENT_SLOT_CHUNK;
+    bucket->nr_slots = first + EVENT_SLOT_CHUNK;
+
+    return 0;
+}
+
+
+
+
+
+
+
+
+/*
+ * Take up to nr free slots out of the event table and store their slot indexes in indexes.
+ * Buckets are tried starting from the given one, which is normally the calling CPU's.
+ * Slots are taken from the head of the free list, the least recently freed first.
+ * Return the number of slots taken. 0 means the table is full.
+ * May sleep to grow a bucket.
+ */
+static int event_table_take(unsigned int start, unsigned int * indexes, int nr)
+{
+    unsigned int i;
+
+    for (i = 0; i <= event_table_mask; i++) {
+        unsigned int index = (start + i) & event_table_mask;
+        struct event_bucket * bucket = &event_table[index];
+        unsigned long flags;
+        int taken = 0;
+
+        /* Lock the bucket. */
+        spin_lock_irqsave(&(bucket->lock), flags);
+        while (taken < nr) {
+            /* Grow while few slots are free, so a freed slot waits behind many others before its reuse. */
+            if (bucket->nr_free < EVENT_SLOT_REUSE_MIN && event_bucket_grow(bucket, &flags) == 0) {
+                continue;
+            }
+            if (bucket->free_head < 0) {
+                break;
+            }
+            /* Pop the least recently freed slot. */
+            unsigned int slot = bucket->free_head;
+            bucket->free_head = event_slot(bucket, slot)->next_free;
+            if (bucket->free_head < 0) {
+                bucket->free_tail = -1;
+            }
+            bucket->nr_free--;
+            indexes[taken++] = (slot << event_table_shift) | index;
+        }
+        spin_unlock_irqrestore(&(bucket->lock), flags);
+        /* Bucket unlocked. */
+
+        if (taken > 0) {
+            return taken;
+        }
+    }
+
+    return 0;
+}
+
+
+
+
+
+
+
+
+/*
+ * Return the nr free slots with the given slot indexes to the tails of their buckets' free lists.
+ * Each run of slots of the same bucket is appended under a single lock.
+ */
+static void event_table_release(const unsigned int * indexes, int nr)
+{
+    int i = 0;
+
+    while (i < nr) {
+        unsigned int index = indexes[i] & event_table_mask;
+        struct event_bucket * bucket = &event_table[index];
+        unsigned long flags;
+
+        /* Lock the bucket. */
+        spin_lock_irqsave(&(bucket->lock), flags);
+        for (; i < nr && (indexes[i] & event_table_mask) == index; i++) {
+            unsigned int slot = indexes[i] >> event_table_shift;
+            event_slot(bucket, slot)->next_free = -1;
+            if (bucket->free_tail < 0) {
+                bucket->free_head = slot;
+            } else {
+                event_slot(bucket, bucket->free_tail)->next_free = slot;
+            }
+            bucket->free_tail = slot;
+            bucket->nr_free++;
+        }
+        spin_unlock_irqrestore(&(bucket->lock), flags);
+        /* Bucket unlocked. */
+    }
+}
+
+
+
+
+
+
+
+
+/*
+ * Put the given event into a free slot and assign its event ID.
+ * The slot comes from the calling CPU's cache. The cache is refilled with a batch
+ * of slots from the table only when it runs empty.
+ * Return the event ID on success.
+ * Return -1 if the table is full.
+ */
+static int event_install(struct event * new_event)
+{
+    struct event_slot_cache * cache = &get_cpu_var(event_slot_cache);
+
+    if (cache->nr == 0) {
+        put_cpu_var(event_slot_cache);
+
+        /* Refill outside the per-CPU section, since growing a bucket may sleep. */
+        unsigned int batch[EVENT_SLOT_BATCH];
+        int taken = event_table_take(raw_smp_processor_id(), batch, EVENT_SLOT_BATCH);
+        if (taken == 0) {
+            return -1;
+        }
+
+        /* We may have moved to another CPU whose cache is not empty. Give back what does not fit. */
+        cache = &get_cpu_var(event_slot_cache);
+        while (taken > 0 && cache->nr < EVENT_SLOT_BATCH) {
+            cache->index[cache->nr++] = batch[--taken];
+        }
+        event_table_release(batch, taken);
+    }
+
+    /* The slot is reserved for this CPU, so it can be filled without any lock. */
+    unsigned int index = cache->index[--cache->nr];
+    unsigned int slot = index >> event_table_shift;
+    struct event_slot * this_slot = event_slot(&event_table[index & event_table_mask], slot);
+
+    new_event->eventID = event_make_ID(index & event_table_mask, slot, this_slot->generation);
+    rcu_assign_pointer(this_slot->event, new_event);
+    put_cpu_var(event_slot_cache);
+
+    return new_event->eventID;
+}
+
+
+
+
+
+
+
+
+/*
+ * Take the given event out of its slot and recycle the slot with the next generation.
+ * The slot joins the calling CPU's batch of freed slots, which goes back to the tails of the buckets once full.
+ * It is never handed straight to the next open, which would recycle a single slot under churn.
+ * Return 0 on success.
+ * Return -1 if a racing close already removed it.
+ */
+static int event_uninstall(struct event * this_event)
+{
+    int eventID = this_event->eventID;
+    unsigned int slot = event_ID_slot(eventID);
+    struct event_slot * this_slot = event_slot(&event_table[eventID & event_table_mask], slot);
+
+    /* Exactly one racing close wins the slot. */
+    if (this_slot == NULL || cmpxchg(&(this_slot->event), this_event, NULL) != this_event) {
+        return -1;
+    }
+
+    /* Generation 0 is skipped so that no event ID is ever 0. */
+    this_slot->generation = (this_slot->generation + 1) & EVENT_ID_GENERATION_MASK;
+    if (this_slot->generation == 0) {
+        this_slot->generation = 1;
+    }
+
+    unsigned int index = (slot << event_table_shift) | (eventID & event_table_mask);
+    struct event_slot_cache * cache = &get_cpu_var(event_slot_cache);
+    cache->freed[cache->nr_freed++] = index;
+    if (cache->nr_freed == EVENT_SLOT_BATCH) {
+        event_table_release(cache->freed, cache->nr_freed);
+        cache->nr_freed = 0;
+    }
+    put_cpu_var(event_slot_cache);
+
+    return 0;
+}
+
+
+
+
+
+
+
+
+/*
+ * Return a pointer to the event with given event ID and take a reference on it.
  * Return NULL if the event with the given event ID is not found.
- * Remember to call read_lock before.
+ * Lookup indexes the event's slot directly and takes no lock. Stale IDs are rejected by generation.
+ * Remember to call put_event() when done with the event.
  */
 struct event * get_event(int eventID)
 {
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
         printk("error get_event(): event not initialized\n");
-        return -1;
+        return (struct event *) NULL;
     }
 
-    
-    struct event * pos;
-    list_for_each_entry(pos, &global_event.eventID_list, eventID_list) {
-        if (pos->eventID == eventID) {
-            return pos;
-        }
+    rcu_read_lock();
+    struct event * this_event = __get_event(eventID);
+    /* An event whose last reference is being dropped is as good as closed. */
+    if (this_event != NULL && atomic_inc_not_zero(&(this_event->refcount)) == 0) {
+        this_event = NULL;
     }
+    rcu_read_unlock();
+
+    return this_event;
+}
+
+
+
 
 
-    return (struct event *) NULL;
+
+
+
+/*
+ * RCU callback freeing a closed event once no lockless reader can see it.
+ */
+static void event_free_rcu(struct rcu_head * head)
+{
+    struct event * this_event = container_of(head, struct event, rcu);
+
+    put_pid(this_event->signaler);
+    kfree(this_event->mailbox);
+    if (this_event->word_pin != NULL) {
+        kunmap(this_event->word_pin->page);
+        put_page(this_event->word_pin->page);
+        kfree(this_event->word_pin);
+    }
+    kmem_cache_free(event_cachep, this_event);
 }
 
 
@@ -73,22 +483,36 @@ struct event * get_event(int eventID)
 
 
 /*
- * Initialize a global event as the head of a linked list of other events.
- * Set event_initialized true.
- * This function should be called in function start_kernel() in linux/init/main.c at kernel boot.
+ * Drop a reference taken by get_event().
+ * The last reference frees the event after an RCU grace period.
+ * Called in process context, as uncharging a bound word takes the mlock accounting lock.
  */
-void doevent_init()
+void put_event(struct event * this_event)
 {
-    eventID_list_lock = RW_LOCK_UNLOCKED;
+    if (atomic_dec_and_test(&(this_event->refcount))) {
+        /* The page stays pinned until the callback, but is no longer reachable through an ID. */
+        if (this_event->word_pin != NULL) {
+            user_shm_unlock(PAGE_SIZE, this_event->word_pin->user);
+        }
+        call_rcu(&(this_event->rcu), event_free_rcu);
+    }
+}
 
-    INIT_LIST_HEAD(&global_event.eventID_list);
 
-    global_event.eventID = 0;
 
-//    global_event.wait_queue_lock = RW_LOCK_UNLOCKED;
 
-    init_waitqueue_head(&global_event.wait_queue);
-    event_initialized = true;
+
+
+
+
+/*
+ * Return true if a task with the given effective uid and gid may wait on or signal the given event.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+static inline bool event_may_access(struct event * this_event, uid_t uid, gid_t gid)
+{
+    return !(uid != 0 && (uid != this_event->UID || this_event->UIDFlag == 0) && (gid != this_event->GID || this_event->GIDFlag == 0));
 }
 
 
@@ -98,48 +522,2597 @@ void doevent_init()
 
 
 /*
- * Create a new event and assign an event ID to it.
- * Add the new event to the global event list.
- * Return event id on success.
+ * Look up the event with the given event ID for a caller that wants to wait on or signal it.
+ * Return the event with a reference held on success.
+ * Return NULL, after printing an error naming the caller, if the event is not found or access is denied.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+static struct event * get_event_access(int eventID, const char * caller)
+{
+    /* Search for the event in the event table. */
+    struct event * this_event = get_event(eventID);
+
+    /* If event not found. */
+    if (this_event == NULL) {
+        printk("error %s(): event not found. eventID = %d\n", caller, eventID);
+        return (struct event *) NULL;
+    }
+
+    /* Check accessibility. */
+    if (!event_may_access(this_event, current->cred->euid, current->cred->egid)) {
+        put_event(this_event);
+        printk("%s(): access denied\n", caller);
+        return (struct event *) NULL;
+    }
+
+    return this_event;
+}
+
+
+
+
+
+
+
+/*
+ * Look up the num events with the given event IDs for a caller that wants to wait on them.
+ * All lookups and access checks are done in a single RCU read-side section.
+ * Return 0 with a reference held on every event in events on success.
+ * Return -1, after printing an error naming the caller and with no reference held, on failure.
+ */
+static int get_events_access(const int * eventIDs, int num, struct event ** events, const char * caller)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error get_events_access(): event not initialized\n");
+        return -1;
+    }
+
+    uid_t uid = current->cred->euid;
+    gid_t gid = current->cred->egid;
+    int i;
+
+    rcu_read_lock();
+    for (i = 0; i < num; i++) {
+        events[i] = __get_event(eventIDs[i]);
+        if (events[i] == NULL || atomic_inc_not_zero(&(events[i]->refcount)) == 0) {
+            rcu_read_unlock();
+            printk("error %s(): event not found. eventID = %d\n", caller, eventIDs[i]);
+            break;
+        }
+        if (!event_may_access(events[i], uid, gid)) {
+            rcu_read_unlock();
+            put_event(events[i]);
+            printk("%s(): access denied\n", caller);
+            break;
+        }
+    }
+    if (i == num) {
+        rcu_read_unlock();
+        return 0;
+    }
+
+    /* Drop the references taken so far. */
+    while (--i >= 0) {
+        put_event(events[i]);
+    }
+    return -1;
+}
+
+
+
+
+
+
+
+/*
+ * Atomically OR the given bits into the given shared event word, and return its old value.
+ */
+static inline int event_word_or(atomic_t * word, int bits)
+{
+    int old = atomic_read(word);
+    for (;;) {
+        int prev = atomic_cmpxchg(word, old, old | bits);
+        if (prev == old) {
+            return old;
+        }
+        old = prev;
+    }
+}
+
+
+
+
+
+
+
+/*
+ * Atomically clear the given bits of the given shared event word, and return its old value.
+ */
+static inline int event_word_andnot(atomic_t * word, int bits)
+{
+    int old = atomic_read(word);
+    for (;;) {
+        int prev = atomic_cmpxchg(word, old, old & ~bits);
+        if (prev == old) {
+            return old;
+        }
+        old = prev;
+    }
+}
+
+
+
+
+
+
+
+/*
+ * Wake up tasks in the waiting queue of the given event, with its wait queue lock held.
+ * All non-exclusive waiters are woken, and up to nr exclusive waiters, or all of them if nr is 0.
+ * If key is not NULL, only waiters whose interest mask intersects key->mask are candidates,
+ * and each woken waiter receives key->value.
+ * The queue is walked once, the way __wake_up() does it, so the count is exact.
+ * The signal sequence number is bumped too, and the signaling task recorded for adaptive waiters.
+ * Wakes follow the event's wake affinity policy.
+ * Return the number of processes actually woken.
+ */
+static int __event_signal_nr(struct event * this_event, int nr, struct event_wake_key * key)
+{
+    /* The policy is read as the signal arrives. A sync wake up lets the scheduler pull the woken task to the waker's CPU. */
+    int wake_flags = (ACCESS_ONCE(this_event->wake_affinity) == EVENT_WAKE_WAKER) ? WF_SYNC : 0;
+    int processes_signaled = 0;
+    wait_queue_t * pos;
+    wait_queue_t * next;
+
+    this_event->seq++;
+
+    /* Every queued waiter is about to be considered, so user space need not enter the kernel again until one re-announces itself. */
+    if (this_event->word != NULL && nr == 0 && key == NULL) {
+        event_word_andnot(this_event->word, EVENT_WORD_WAITERS);
+    }
+
+    /* Adaptive waiters spin only while the task that signals them runs. */
+    if (test_bit(EVENT_ADAPTIVE, &(this_event->status)) && this_event->signaler != task_pid(current)) {
+        put_pid(this_event->signaler);
+        this_event->signaler = get_pid(task_pid(current));
+    }
+
+    list_for_each_entry_safe(pos, next, &(this_event->wait_queue.task_list), task_list) {
+        /* The wake function may remove the entry, so read its flags first. */
+        unsigned int wait_flags = pos->flags;
+
+        /* The wake function returns 0 if the task was not woken. */
+        if (pos->func(pos, TASK_NORMAL, wake_flags, key) == 0) {
+            continue;
+        }
+        processes_signaled++;
+
+        if ((wait_flags & WQ_FLAG_EXCLUSIVE) && nr > 0 && --nr == 0) {
+            break;
+        }
+    }
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+
+/*
+ * Wake up tasks in the waiting queue of the given event.
+ * All non-exclusive waiters are woken, and up to nr exclusive waiters, or all of them if nr is 0.
+ * The queue is walked once under its lock, so the count is exact.
+ * Return the number of processes actually woken.
+ */
+int event_signal_nr(struct event * this_event, int nr)
+{
+    unsigned long flags;
+
+    /* Lock wait queue. */
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    int processes_signaled = __event_signal_nr(this_event, nr, NULL);
+    /* Unlock wait queue. */
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+
+/*
+ * Wake up all tasks in the waiting queue of the given event.
+ * Return the number of processes signaled.
+ */
+int event_signal(struct event * this_event)
+{
+    return event_signal_nr(this_event, 0);
+}
+
+
+
+
+
+
+
+/*
+ * Wake function of an event_waiter.
+ * Record that the waiter was signaled before waking it, so it cannot mistake the wake up
+ * for a spurious one, then take it off the queue. The waiter counts as woken even if it
+ * was still running, so wake-one signals are never lost on a waiter that is about to leave.
+ * A signal may pass a struct event_wake_key as key. Waiters whose interest mask does not intersect
+ * its fire mask are skipped, and the others receive its value.
+ */
+static int event_wake_function(wait_queue_t * wait, unsigned mode, int sync, void * key)
+{
+    struct event_waiter * waiter = container_of(wait, struct event_waiter, wait);
+    struct event_wake_key * wake_key = key;
+
+    if (wake_key != NULL) {
+        if ((wake_key->mask & waiter->mask) == 0) {
+            return 0;
+        }
+        waiter->value = wake_key->value;
+    }
+
+    /*
+     * Unlink only after the wake up, as autoremove_wake_function() does. A waiter already running
+     * may see the empty list in finish_wait() and free itself before default_wake_function() reads it.
+     */
+    waiter->woken = 1;
+    default_wake_function(wait, mode, sync, key);
+    list_del_init(&(wait->task_list));
+    return 1;
+}
+
+
+
+
+
+
+
+/*
+ * Initialize an event_waiter for the calling task.
+ */
+static void event_waiter_init(struct event_waiter * waiter)
+{
+    init_waitqueue_func_entry(&(waiter->wait), event_wake_function);
+    waiter->wait.private = current;
+    INIT_LIST_HEAD(&(waiter->wait.task_list));
+    waiter->woken = 0;
+    waiter->mask = EVENT_MASK_ALL;
+    waiter->value = 0;
+}
+
+
+
+
+
+
+
+/*
+ * Tell user space signalers of the given event, if it has a shared word, that a task is about to sleep on it.
+ * Call after queueing: a signaler that sets EVENT_WORD_SIGNALED after this sees EVENT_WORD_WAITERS and
+ * enters the kernel, and one that set it before is seen by event_fired().
+ */
+static inline void event_word_announce(struct event * this_event)
+{
+    atomic_t * word = ACCESS_ONCE(this_event->word);
+    if (word != NULL && (atomic_read(word) & EVENT_WORD_WAITERS) == 0) {
+        event_word_or(word, EVENT_WORD_WAITERS);
+    }
+}
+
+
+
+
+
+
+
+/*
+ * Queue the calling task on the wait queues of the num given events, with one event_waiter per event from waiters.
+ * An exclusive waiter is queued at the tail and only woken by a signal that picks it,
+ * so a wake-one signal releases one exclusive waiter instead of all of them.
+ */
+static void event_wait_prepare(struct event ** events, struct event_waiter * waiters, int num, int exclusive)
+{
+    int i;
+
+    /* 
+     * Lock wait_queue so that no other process can wait on or wake up the wait queue,
+     * until this process has changed its status.
+     */
+    /* Change task status to either TASK_INTERRUPTIBLE or TASK_UNINTERRUPTIBLE. */
+    for (i = 0; i < num; i++) {
+        event_waiter_init(&waiters[i]);
+        if (exclusive) {
+            prepare_to_wait_exclusive(&(events[i]->wait_queue), &(waiters[i].wait), TASK_INTERRUPTIBLE);
+        } else {
+            prepare_to_wait(&(events[i]->wait_queue), &(waiters[i].wait), TASK_INTERRUPTIBLE);
+        }
+        event_word_announce(events[i]);
+    }
+    /* 
+     * Wait queues have been unlocked.
+     * Other process can wait on these queues or wake up tasks on these queues.
+     */
+}
+
+
+
+
+
+
+
+/*
+ * Take the calling task off the wait queues it was queued on by event_wait_prepare().
+ */
+static void event_wait_finish(struct event ** events, struct event_waiter * waiters, int num)
+{
+    int i;
+    for (i = 0; i < num; i++) {
+        finish_wait(&(events[i]->wait_queue), &(waiters[i].wait));
+    }
+}
+
+
+
+
+
+
+
+/*
+ * Sleep once, until woken, interrupted or, if expires is not NULL, until that CLOCK_MONOTONIC time, driven by an hrtimer.
+ * The task must be queued and in TASK_INTERRUPTIBLE; it is put back in TASK_INTERRUPTIBLE before returning 0.
+ * Return 0 if woken, which may be spurious.
+ * Return -ETIMEDOUT if the deadline passed.
+ * Return -EINTR if a signal is pending.
+ */
+static long event_wait_schedule(ktime_t * expires)
+{
+    if (signal_pending(current)) {
+        return -EINTR;
+    }
+    if (expires == NULL) {
+        schedule();
+    } else if (schedule_hrtimeout_range(expires, current->timer_slack_ns, HRTIMER_MODE_ABS) == 0) {
+        return -ETIMEDOUT;
+    }
+    set_current_state(TASK_INTERRUPTIBLE);
+    return 0;
+}
+
+
+
+
+
+
+
+/*
+ * Return true if the event waited on by the given waiter has fired: it signaled the waiter, it is set,
+ * in the kernel or in its shared word, or it was closed.
+ * A closed event will never be signaled again.
+ */
+static inline bool event_fired(struct event * this_event, struct event_waiter * waiter)
+{
+    if (waiter->woken || (this_event->status & ((1UL << EVENT_SIGNALED) | (1UL << EVENT_CLOSED))) != 0) {
+        return true;
+    }
+
+    atomic_t * word = ACCESS_ONCE(this_event->word);
+    return word != NULL && (atomic_read(word) & EVENT_WORD_SIGNALED) != 0;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait in the wait queues of the num given events until one of them is signaled or closed.
+ * waiters provides one event_waiter per event.
+ * See event_wait_prepare() for the meaning of exclusive and event_wait_schedule() for expires.
+ * Return the lowest index of a signaled or closed event.
+ * Return -ETIMEDOUT if the deadline passed first.
+ * Return -EINTR if a signal is pending first.
+ */
+static long event_wait_any(struct event ** events, struct event_waiter * waiters, int num, int exclusive, ktime_t * expires)
+{
+    long ret = 0;
+    int i;
+
+    event_wait_prepare(events, waiters, num, exclusive);
+    for (;;) {
+        for (i = 0; i < num; i++) {
+            if (event_fired(events[i], &waiters[i])) {
+                break;
+            }
+        }
+        if (i < num) {
+            ret = i;
+            break;
+        }
+        if ((ret = event_wait_schedule(expires)) != 0) {
+            break;
+        }
+    }
+    event_wait_finish(events, waiters, num);
+
+    /* A signal that raced with the timeout or an interruption still counts. */
+    for (i = 0; ret < 0 && i < num; i++) {
+        if (waiters[i].woken) {
+            ret = i;
+        }
+    }
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait in the wait queues of the num given events until every one of them has been signaled or closed.
+ * Each event counts once, however often it is signaled.
+ * waiters provides one event_waiter per event; afterwards, event_fired() tells which events fired.
+ * See event_wait_schedule() for the meaning of expires.
+ * Return 0 if all events fired.
+ * Return -ETIMEDOUT if the deadline passed first.
+ * Return -EINTR if a signal is pending first.
+ */
+static long event_wait_all(struct event ** events, struct event_waiter * waiters, int num, ktime_t * expires)
+{
+    long ret = 0;
+    int i;
+
+    event_wait_prepare(events, waiters, num, 0);
+    for (;;) {
+        for (i = 0; i < num; i++) {
+            if (!event_fired(events[i], &waiters[i])) {
+                break;
+            }
+        }
+        if (i == num) {
+            ret = 0;
+            break;
+        }
+        if ((ret = event_wait_schedule(expires)) != 0) {
+            break;
+        }
+    }
+    event_wait_finish(events, waiters, num);
+
+    /* Signals that raced with the timeout or an interruption still count. */
+    for (i = 0; ret < 0 && i < num; i++) {
+        if (!event_fired(events[i], &waiters[i])) {
+            break;
+        }
+    }
+    if (i == num) {
+        ret = 0;
+    }
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Spin on the given adaptive event, for at most event_spin_ns, while the task that last signaled it runs on a CPU.
+ * A signaler that is running is likely to signal again soon, and catching that signal
+ * here saves the sleep and the wake up through the scheduler.
+ * If expires is not NULL, the spin also stops at that CLOCK_MONOTONIC time, and does not start if it has passed.
+ * Return true if the event was signaled, set or closed while spinning, before the deadline.
+ */
+static bool event_spin(struct event * this_event, ktime_t * expires)
+{
+    unsigned int seq = ACCESS_ONCE(this_event->seq);
+    struct task_struct * signaler_task;
+    struct pid * signaler;
+    unsigned long flags;
+    bool fired = false;
+
+    if (event_spin_ns == 0 || num_online_cpus() == 1) {
+        return false;
+    }
+
+    /* Never spin past the caller's own deadline. */
+    s64 now = ktime_to_ns(ktime_get());
+    s64 deadline = now + event_spin_ns;
+    if (expires != NULL && ktime_to_ns(*expires) < deadline) {
+        deadline = ktime_to_ns(*expires);
+    }
+    if (now >= deadline) {
+        return false;
+    }
+
+    /* Hold our own reference, as the next signaler replaces the event's. */
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    signaler = get_pid(this_event->signaler);
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+    if (signaler == NULL || signaler == task_pid(current)) {
+        put_pid(signaler);
+        return false;
+    }
+
+    while (!need_resched() && !signal_pending(current)) {
+        /* Check the clock first, so that a signal seen after the deadline is left to event_wait_any(). */
+        if (ktime_to_ns(ktime_get()) >= deadline) {
+            break;
+        }
+        if (ACCESS_ONCE(this_event->seq) != seq || (this_event->status & ((1UL << EVENT_SIGNALED) | (1UL << EVENT_CLOSED))) != 0) {
+            fired = true;
+            break;
+        }
+
+        rcu_read_lock();
+        signaler_task = pid_task(signaler, PIDTYPE_PID);
+        bool running = signaler_task != NULL && task_curr(signaler_task);
+        rcu_read_unlock();
+        if (!running) {
+            break;
+        }
+
+        cpu_relax();
+    }
+    put_pid(signaler);
+
+    return fired;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait in the wait queue of the given event until it is signaled or closed.
+ * See event_wait_any() for the meaning of exclusive and expires.
+ * A non-exclusive wait on an adaptive event spins first, see event_spin().
+ * Exclusive waits do not spin, as every spinner would take the same wake-one signal.
+ * Return 0 if signaled or closed.
+ * Return -ETIMEDOUT if the deadline passed first.
+ * Return -EINTR if a signal is pending first.
+ */
+static long event_wait(struct event * this_event, int exclusive, ktime_t * expires)
+{
+    struct event_waiter waiter;
+
+    if (!exclusive && test_bit(EVENT_ADAPTIVE, &(this_event->status)) && event_spin(this_event, expires)) {
+        return 0;
+    }
+
+    long ret = event_wait_any(&this_event, &waiter, 1, exclusive, expires);
+
+    return (ret < 0) ? ret : 0;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait in the wait queue of the given event until it is signaled, set or closed,
+ * unless the signal sequence number of the event differs from seq.
+ * The sequence number is checked after queueing, and signals bump it under the queue lock,
+ * so either the check sees a signal or the signal finds the task queued.
+ * Return 0 if signaled, set or closed.
+ * Return -EAGAIN if the sequence number differs from seq.
+ * Return -EINTR if a signal is pending first.
+ */
+static long event_wait_seq(struct event * this_event, unsigned int seq)
+{
+    struct event_waiter waiter;
+    long ret;
+
+    event_wait_prepare(&this_event, &waiter, 1, 0);
+    for (;;) {
+        if (event_fired(this_event, &waiter)) {
+            ret = 0;
+            break;
+        }
+        if (ACCESS_ONCE(this_event->seq) != seq) {
+            ret = -EAGAIN;
+            break;
+        }
+        if ((ret = event_wait_schedule(NULL)) != 0) {
+            break;
+        }
+    }
+    event_wait_finish(&this_event, &waiter, 1);
+
+    /* A signal that raced with an interruption still counts. */
+    if (waiter.woken) {
+        ret = 0;
+    }
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait in the wait queue of the given event until it is signaled with a fire mask
+ * that intersects the given interest mask, or set or closed.
+ * Unmasked signals fire all bits.
+ * Return 0 if signaled, set or closed.
+ * Return -EINTR if a signal is pending first.
+ */
+static long event_wait_mask(struct event * this_event, unsigned int mask)
+{
+    struct event_waiter waiter;
+    long ret;
+
+    event_waiter_init(&waiter);
+    waiter.mask = mask;
+    prepare_to_wait(&(this_event->wait_queue), &(waiter.wait), TASK_INTERRUPTIBLE);
+    event_word_announce(this_event);
+    for (;;) {
+        if (event_fired(this_event, &waiter)) {
+            ret = 0;
+            break;
+        }
+        if ((ret = event_wait_schedule(NULL)) != 0) {
+            break;
+        }
+    }
+    event_wait_finish(&this_event, &waiter, 1);
+
+    /* A signal that raced with an interruption still counts. */
+    if (waiter.woken) {
+        ret = 0;
+    }
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Wake up the tasks waiting in the given event whose interest mask intersects key->mask, in one pass,
+ * and deliver key->value to each of them.
+ * Return the number of processes actually woken.
+ */
+static int event_signal_key(struct event * this_event, struct event_wake_key * key)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    int processes_signaled = __event_signal_nr(this_event, 0, key);
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+
+/*
+ * Return true if the given flag state satisfies a wait for the given bits with the given EVENT_FLAG_* flags.
+ */
+static inline bool event_flags_match(unsigned int state, unsigned int bits, int flags)
+{
+    if (flags & EVENT_FLAG_ALL) {
+        return (state & bits) == bits;
+    }
+    return (state & bits) != 0;
+}
+
+
+
+
+
+
+
+/*
+ * Consume the flag state of the given event for the given flag waiter, with the wait queue lock held.
+ * Return true if the waiter's condition holds, after recording the state and applying EVENT_FLAG_CLEAR.
+ */
+static bool __event_flags_take(struct event * this_event, struct event_flag_waiter * flag_waiter)
+{
+    if (!event_flags_match(this_event->flag_state, flag_waiter->bits, flag_waiter->flags)) {
+        return false;
+    }
+
+    flag_waiter->state = this_event->flag_state;
+    if (flag_waiter->flags & EVENT_FLAG_CLEAR) {
+        this_event->flag_state &= ~(flag_waiter->bits);
+    }
+    return true;
+}
+
+
+
+
+
+
+
+/*
+ * Wake function of an event_flag_waiter.
+ * Runs under the wait queue lock, so the condition is checked and consumed atomically with the wake up.
+ * Waiters whose condition does not hold are skipped, unless the event was closed.
+ */
+static int event_flag_wake_function(wait_queue_t * wait, unsigned mode, int sync, void * key)
+{
+    struct event_flag_waiter * flag_waiter = container_of(wait, struct event_flag_waiter, waiter.wait);
+
+    if (!test_bit(EVENT_CLOSED, &(flag_waiter->event->status)) && !__event_flags_take(flag_waiter->event, flag_waiter)) {
+        return 0;
+    }
+
+    return event_wake_function(wait, mode, sync, NULL);
+}
+
+
+
+
+
+
+
+/*
+ * Wake up the flag waiters of the given event whose condition now holds, with its wait queue lock held.
+ * Other waiters are left alone, and the signal sequence number is not bumped, as setting flag bits is not a signal.
+ * Return the number of processes actually woken.
+ */
+static int __event_flags_wake(struct event * this_event)
+{
+    int wake_flags = (ACCESS_ONCE(this_event->wake_affinity) == EVENT_WAKE_WAKER) ? WF_SYNC : 0;
+    int processes_signaled = 0;
+    wait_queue_t * pos;
+    wait_queue_t * next;
+
+    list_for_each_entry_safe(pos, next, &(this_event->wait_queue.task_list), task_list) {
+        if (pos->func == event_flag_wake_function && pos->func(pos, TASK_NORMAL, wake_flags, NULL) != 0) {
+            processes_signaled++;
+        }
+    }
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait until its condition on the flag bits of the given event holds.
+ * See sys_doeventflagwait() for the meaning of bits and flags.
+ * Return the flag state that satisfied the wait, from before any clearing.
+ * Return 0 if the event was closed.
+ * Return -EINTR if a signal is pending first.
+ */
+static long event_flag_wait(struct event * this_event, unsigned int bits, int flags)
+{
+    struct event_flag_waiter flag_waiter;
+    unsigned long irq_flags;
+    long ret;
+
+    flag_waiter.event = this_event;
+    flag_waiter.bits = bits;
+    flag_waiter.flags = flags;
+    flag_waiter.state = 0;
+
+    /* Check the condition and queue in one step under the wait queue lock. */
+    spin_lock_irqsave(&(this_event->wait_queue.lock), irq_flags);
+    if (__event_flags_take(this_event, &flag_waiter)) {
+        spin_unlock_irqrestore(&(this_event->wait_queue.lock), irq_flags);
+        return flag_waiter.state;
+    }
+    if (test_bit(EVENT_CLOSED, &(this_event->status))) {
+        spin_unlock_irqrestore(&(this_event->wait_queue.lock), irq_flags);
+        return 0;
+    }
+    event_waiter_init(&(flag_waiter.waiter));
+    flag_waiter.waiter.wait.func = event_flag_wake_function;
+    __add_wait_queue_tail(&(this_event->wait_queue), &(flag_waiter.waiter.wait));
+    set_current_state(TASK_INTERRUPTIBLE);
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), irq_flags);
+
+    for (;;) {
+        if (flag_waiter.waiter.woken) {
+            ret = flag_waiter.state;
+            break;
+        }
+        if ((ret = event_wait_schedule(NULL)) != 0) {
+            break;
+        }
+    }
+    event_wait_finish(&this_event, &(flag_waiter.waiter), 1);
+
+    /* A wake up that raced with an interruption already consumed the bits, so it still counts. */
+    if (flag_waiter.waiter.woken) {
+        ret = flag_waiter.state;
+    }
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Take a unit of the given semaphore or auto-reset event if one is available, without touching its wait queue.
+ * The unit of an auto-reset event is its EVENT_SIGNALED bit.
+ * Return true if a unit was taken.
+ */
+static inline bool event_sem_trydown(struct event * this_event)
+{
+    if (this_event->type == EVENT_TYPE_AUTORESET) {
+        /* Test first, so that waiters polling a reset event do not bounce its cache line. */
+        return test_bit(EVENT_SIGNALED, &(this_event->status)) && test_and_clear_bit(EVENT_SIGNALED, &(this_event->status));
+    }
+
+    int count = atomic_read(&(this_event->count));
+    while (count > 0) {
+        int old = atomic_cmpxchg(&(this_event->count), count, count - 1);
+        if (old == count) {
+            return true;
+        }
+        count = old;
+    }
+    return false;
+}
+
+
+
+
+
+
+
+/*
+ * Take a unit of the given semaphore or auto-reset event, waiting exclusively for one if none is available.
+ * See event_wait_schedule() for the meaning of expires.
+ * Return 0 if a unit was taken or the event was closed.
+ * Return -ETIMEDOUT if the deadline passed first.
+ * Return -EINTR if a signal is pending first.
+ */
+static long event_sem_down(struct event * this_event, ktime_t * expires)
+{
+    struct event_waiter waiter;
+    long ret;
+
+    /* Fast path: a unit is available, so the wait queue lock is never taken. */
+    if (event_sem_trydown(this_event)) {
+        return 0;
+    }
+
+    /*
+     * Queue before retrying, so that a unit added after the retry finds this task queued.
+     * prepare_to_wait_exclusive() ends with a full barrier, which pairs with the one in event_sem_up().
+     */
+    event_wait_prepare(&this_event, &waiter, 1, 1);
+    for (;;) {
+        if (event_sem_trydown(this_event) || test_bit(EVENT_CLOSED, &(this_event->status))) {
+            ret = 0;
+            break;
+        }
+        /* Woken, but a fast path took the unit first. Queue again. */
+        if (waiter.woken) {
+            event_wait_prepare(&this_event, &waiter, 1, 1);
+            continue;
+        }
+        if ((ret = event_wait_schedule(expires)) != 0) {
+            break;
+        }
+    }
+    event_wait_finish(&this_event, &waiter, 1);
+
+    /*
+     * A unit that raced with the timeout or an interruption still counts.
+     * Taking it also keeps the wake meant for this task from being lost.
+     */
+    if (ret < 0 && event_sem_trydown(this_event)) {
+        ret = 0;
+    }
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Add nr units to the given semaphore event, and wake up to nr of its waiters.
+ * An auto-reset event is set instead, whatever nr, and at most one waiter is woken.
+ * Without waiters, the wait queue lock is never taken.
+ * Return the number of processes actually woken.
+ * Return -EOVERFLOW, adding nothing, if the semaphore would hold more than INT_MAX units.
+ */
+static int event_sem_up(struct event * this_event, int nr)
+{
+    /* Either a waiter queued before this sees the waiter, or the waiter sees the units. */
+    if (this_event->type == EVENT_TYPE_AUTORESET) {
+        set_bit(EVENT_SIGNALED, &(this_event->status));
+        smp_mb();
+        nr = 1;
+    } else {
+        /* A successful atomic_cmpxchg() is a full barrier. */
+        int count = atomic_read(&(this_event->count));
+        for (;;) {
+            if (count > INT_MAX - nr) {
+                return -EOVERFLOW;
+            }
+            int old = atomic_cmpxchg(&(this_event->count), count, count + nr);
+            if (old == count) {
+                break;
+            }
+            count = old;
+        }
+    }
+    if (!waitqueue_active(&(this_event->wait_queue))) {
+        return 0;
+    }
+
+    return event_signal_nr(this_event, nr);
+}
+
+
+
+
+
+
+
+/*
+ * Arrive at the given barrier event, and wait until all its participants have arrived or it is signaled or closed.
+ * The last participant to arrive releases the whole cohort under the wait queue lock, and the barrier re-arms for the next phase.
+ * The phase is the signal sequence number, which every release bumps.
+ * See event_wait_schedule() for the meaning of expires.
+ * Return 0 if released or closed.
+ * Return -ETIMEDOUT if the deadline passed first.
+ * Return -EINTR if a signal is pending first.
+ * A participant that gives up before its phase is released no longer counts as arrived.
+ */
+static long event_barrier_wait(struct event * this_event, ktime_t * expires)
+{
+    struct event_waiter waiter;
+    unsigned long flags;
+    long ret;
+
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    if (test_bit(EVENT_CLOSED, &(this_event->status))) {
+        spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+        return 0;
+    }
+
+    /* The last to arrive releases everyone and re-arms the barrier. */
+    if (atomic_read(&(this_event->count)) + 1 >= this_event->participants) {
+        atomic_set(&(this_event->count), 0);
+        __event_signal_nr(this_event, 0, NULL);
+        spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+        return 0;
+    }
+    atomic_inc(&(this_event->count));
+    unsigned int phase = this_event->seq;
+
+    /* Queue with the lock still held, so the arrival and the queueing are one step. */
+    event_waiter_init(&waiter);
+    __add_wait_queue_tail(&(this_event->wait_queue), &(waiter.wait));
+    set_current_state(TASK_INTERRUPTIBLE);
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+
+    for (;;) {
+        if (waiter.woken || ACCESS_ONCE(this_event->seq) != phase || test_bit(EVENT_CLOSED, &(this_event->status))) {
+            ret = 0;
+            break;
+        }
+        if ((ret = event_wait_schedule(expires)) != 0) {
+            break;
+        }
+    }
+    event_wait_finish(&this_event, &waiter, 1);
+
+    /* Withdraw the arrival, unless the phase was released meanwhile. */
+    if (ret < 0) {
+        spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+        if (this_event->seq == phase) {
+            atomic_dec(&(this_event->count));
+        } else {
+            ret = 0;
+        }
+        spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+    }
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Release all participants waiting at the given barrier event now, and re-arm it for the next phase.
+ * Return the number of processes actually woken.
+ */
+static int event_barrier_release(struct event * this_event)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    atomic_set(&(this_event->count), 0);
+    int processes_signaled = __event_signal_nr(this_event, 0, NULL);
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+
+/*
+ * Queue the given mailbox waiter exclusively on the wait queue of the given event, with its lock held, unless it is already queued.
+ */
+static void __event_mbox_queue(struct event * this_event, struct event_waiter * waiter)
+{
+    if (list_empty(&(waiter->wait.task_list))) {
+        waiter->woken = 0;
+        waiter->wait.flags |= WQ_FLAG_EXCLUSIVE;
+        __add_wait_queue_tail(&(this_event->wait_queue), &(waiter->wait));
+    }
+    set_current_state(TASK_INTERRUPTIBLE);
+}
+
+
+
+
+
+
+
+/*
+ * Take the given mailbox waiter off the wait queue of the given event, with its lock held.
+ */
+static void __event_mbox_dequeue(struct event * this_event, struct event_waiter * waiter)
+{
+    __set_current_state(TASK_RUNNING);
+    if (!list_empty(&(waiter->wait.task_list))) {
+        list_del_init(&(waiter->wait.task_list));
+    }
+}
+
+
+
+
+
+
+
+/*
+ * Dequeue the oldest message of the given mailbox event into value, waiting for one while the queue is empty.
+ * Receivers and blocked senders share the wait queue, told apart by their interest masks,
+ * so a send wakes exactly one receiver and a receive exactly one blocked sender.
+ * See event_wait_schedule() for the meaning of expires.
+ * Return 0 on success.
+ * Return -EPIPE if the event was closed and the queue is empty.
+ * Return -ETIMEDOUT if the deadline passed first.
+ * Return -EINTR if a signal is pending first.
+ */
+static long event_mbox_receive(struct event * this_event, u64 * value, ktime_t * expires)
+{
+    struct event_mailbox * mailbox = this_event->mailbox;
+    struct event_wake_key receiver_key = { .mask = EVENT_MAILBOX_RECEIVER, .value = 0 };
+    struct event_wake_key sender_key = { .mask = EVENT_MAILBOX_SENDER, .value = 0 };
+    struct event_waiter waiter;
+    unsigned long flags;
+    long ret;
+
+    event_waiter_init(&waiter);
+    waiter.mask = EVENT_MAILBOX_RECEIVER;
+
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    for (;;) {
+        if (mailbox->count > 0) {
+            *value = mailbox->ring[mailbox->head];
+            mailbox->head = (mailbox->head + 1) % mailbox->capacity;
+            mailbox->count--;
+            /* Make room for one blocked sender. */
+            __event_signal_nr(this_event, 1, &sender_key);
+            ret = 0;
+            break;
+        }
+        if (test_bit(EVENT_CLOSED, &(this_event->status))) {
+            ret = -EPIPE;
+            break;
+        }
+
+        __event_mbox_queue(this_event, &waiter);
+        spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+        ret = event_wait_schedule(expires);
+        spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+        if (ret != 0) {
+            /* Pass on a wake up meant for this task, so the message it announced is not left waiting. */
+            if (waiter.woken && mailbox->count > 0) {
+                __event_signal_nr(this_event, 1, &receiver_key);
+            }
+            break;
+        }
+    }
+    __event_mbox_dequeue(this_event, &waiter);
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Enqueue the given message in the given mailbox event, and wake up one receiver.
+ * If the queue is full, act on the mailbox's full policy, except that with nonblock EVENT_MAILBOX_FULL_BLOCK
+ * fails like EVENT_MAILBOX_FULL_FAIL instead of waiting for room.
+ * Return the number of processes actually woken on success.
+ * Return -EAGAIN if the queue is full and the policy is EVENT_MAILBOX_FULL_FAIL, or nonblock is set.
+ * Return -EPIPE if the event was closed.
+ * Return -EINTR if a signal is pending before there is room.
+ */
+static long event_mbox_send(struct event * this_event, u64 value, int nonblock)
+{
+    struct event_mailbox * mailbox = this_event->mailbox;
+    struct event_wake_key receiver_key = { .mask = EVENT_MAILBOX_RECEIVER, .value = 0 };
+    struct event_wake_key sender_key = { .mask = EVENT_MAILBOX_SENDER, .value = 0 };
+    struct event_waiter waiter;
+    unsigned long flags;
+    long ret;
+
+    event_waiter_init(&waiter);
+    waiter.mask = EVENT_MAILBOX_SENDER;
+
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    for (;;) {
+        if (test_bit(EVENT_CLOSED, &(this_event->status))) {
+            ret = -EPIPE;
+            break;
+        }
+        if (mailbox->count == mailbox->capacity) {
+            if (mailbox->full_policy == EVENT_MAILBOX_FULL_FAIL || (mailbox->full_policy == EVENT_MAILBOX_FULL_BLOCK && nonblock)) {
+                ret = -EAGAIN;
+                break;
+            }
+            if (mailbox->full_policy == EVENT_MAILBOX_FULL_OVERWRITE) {
+                mailbox->head = (mailbox->head + 1) % mailbox->capacity;
+                mailbox->count--;
+            }
+        }
+        if (mailbox->count < mailbox->capacity) {
+            mailbox->ring[(mailbox->head + mailbox->count) % mailbox->capacity] = value;
+            mailbox->count++;
+            ret = __event_signal_nr(this_event, 1, &receiver_key);
+            break;
+        }
+
+        /* EVENT_MAILBOX_FULL_BLOCK: wait for a receiver to make room. */
+        __event_mbox_queue(this_event, &waiter);
+        spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+        ret = event_wait_schedule(NULL);
+        spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+        if (ret != 0) {
+            /* Pass on a wake up meant for this task, so the room it announced is not left unused. */
+            if (waiter.woken && mailbox->count < mailbox->capacity) {
+                __event_signal_nr(this_event, 1, &sender_key);
+            }
+            break;
+        }
+    }
+    __event_mbox_dequeue(this_event, &waiter);
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+
+    return ret;
+}
+
+
+
+
+
+
+
+/*
+ * Enqueue nr 0 messages in the given mailbox event for the plain signal calls, without ever waiting for room.
+ * Stop at the first message that cannot be enqueued. Past the capacity the messages could only overwrite
+ * one another, so at most the capacity is enqueued.
+ * Return the number of processes actually woken if at least one message was enqueued.
+ * Otherwise return the error of event_mbox_send().
+ */
+static long event_mbox_signal(struct event * this_event, int nr)
+{
+    long woken = 0;
+    unsigned int i;
+
+    for (i = 0; i < min_t(unsigned int, nr, this_event->mailbox->capacity); i++) {
+        long ret = event_mbox_send(this_event, 0, 1);
+        if (ret < 0) {
+            return (i == 0) ? ret : woken;
+        }
+        woken += ret;
+    }
+
+    return woken;
+}
+
+
+
+
+
+
+
+/*
+ * Wait on the given event the way its type does.
+ * See event_wait() for the meaning of exclusive and expires, and for the return values.
+ */
+static long event_do_wait(struct event * this_event, int exclusive, ktime_t * expires)
+{
+    switch (this_event->type) {
+    case EVENT_TYPE_SEMAPHORE:
+    case EVENT_TYPE_AUTORESET:
+        return event_sem_down(this_event, expires);
+    case EVENT_TYPE_BARRIER:
+        return event_barrier_wait(this_event, expires);
+    case EVENT_TYPE_MAILBOX: {
+        u64 value;
+        return event_mbox_receive(this_event, &value, expires);
+    }
+    default:
+        return event_wait(this_event, exclusive, expires);
+    }
+}
+
+
+
+
+
+
+
+/*
+ * Signal the given event the way its type does.
+ * nr is the number of exclusive waiters to wake, or 0 to wake all of them, as for event_signal_nr().
+ * A semaphore event gets nr units instead, or one if nr is 0, an auto-reset event is set,
+ * a barrier event releases all its waiting participants, and a mailbox event gets nr 0 messages, or one if nr is 0.
+ * Never blocks.
+ * Return the number of processes actually woken.
+ * Return -EOVERFLOW if a semaphore event would overflow, see event_sem_up().
+ * Return -EAGAIN or -EPIPE if no message could be enqueued in a mailbox event, see event_mbox_signal().
+ */
+static int event_do_signal(struct event * this_event, int nr)
+{
+    switch (this_event->type) {
+    case EVENT_TYPE_SEMAPHORE:
+    case EVENT_TYPE_AUTORESET:
+        return event_sem_up(this_event, (nr > 0) ? nr : 1);
+    case EVENT_TYPE_BARRIER:
+        return event_barrier_release(this_event);
+    case EVENT_TYPE_MAILBOX:
+        return event_mbox_signal(this_event, (nr > 0) ? nr : 1);
+    default:
+        return event_signal_nr(this_event, nr);
+    }
+}
+
+
+
+
+
+
+
+/*
+ * Return true if the given event is of EVENT_TYPE_NORMAL.
+ * Otherwise print an error naming the caller, which only supports that type, and return false.
+ */
+static bool event_check_normal(struct event * this_event, const char * caller)
+{
+    if (this_event->type != EVENT_TYPE_NORMAL) {
+        printk("error %s(): not supported on this event type. eventID = %d\n", caller, this_event->eventID);
+        return false;
+    }
+    return true;
+}
+
+
+
+
+
+
+
+/*
+ * Read a timeout from user space and turn it into a CLOCK_MONOTONIC deadline.
+ * timeout is relative, or absolute if flags has EVENT_WAIT_ABSTIME.
+ * A deadline, unlike a relative time, is not restarted by spurious wake ups.
+ * Return 0 on success.
+ * Return -1, after printing an error naming the caller, on failure.
+ */
+static int event_timeout_to_deadline(struct timespec * timeout, int flags, ktime_t * expires, const char * caller)
+{
+    struct timespec sys_timeout;
+    if (copy_from_user(&sys_timeout, timeout, sizeof(struct timespec)) != 0) {
+        printk("error %s(): copy_from_user()\n", caller);
+        return -1;
+    }
+    if (!timespec_valid(&sys_timeout)) {
+        printk("error %s(): invalid timeout\n", caller);
+        return -1;
+    }
+
+    *expires = timespec_to_ktime(sys_timeout);
+    if (!(flags & EVENT_WAIT_ABSTIME)) {
+        *expires = ktime_add_safe(ktime_get(), *expires);
+    }
+
+    return 0;
+}
+
+
+
+
+
+
+
+/*
+ * Slab constructor of struct event.
+ * Set up the fields that are the same in every free event, so sys_doeventopen() can skip them.
+ * An event is only freed once its wait queue is empty, which keeps the invariant.
+ */
+static void event_ctor(void * object)
+{
+    struct event * this_event = (struct event *) object;
+
+    /* Initialize wait queue. */
+    init_waitqueue_head(&(this_event->wait_queue));
+}
+
+
+
+
+
+
+
+/*
+ * Compare two event IDs for sort().
+ */
+static int event_ID_cmp(const void * a, const void * b)
+{
+    return *(const int *) a - *(const int *) b;
+}
+
+
+
+
+
+
+
+/*
+ * Allocate the event table with the bucket count given at boot, rounded up to a power of two.
+ * Set event_initialized true.
+ * This function should be called in function start_kernel() in linux/init/main.c at kernel boot.
+ */
+void doevent_init()
+{
+    unsigned int buckets = roundup_pow_of_two(event_table_buckets);
+
+    event_cachep = kmem_cache_create("event", sizeof(struct event), __alignof__(struct event), SLAB_HWCACHE_ALIGN, event_ctor);
+    if (event_cachep == NULL) {
+        printk("error doevent_init(): kmem_cache_create()\n");
+        return;
+    }
+
+    event_table_shift = ilog2(buckets);
+    event_table_mask = buckets - 1;
+    event_bucket_slots = 1 << (EVENT_ID_INDEX_BITS - event_table_shift);
+
+    event_table = kmalloc(buckets * sizeof(struct event_bucket), GFP_KERNEL);
+    if (event_table == NULL) {
+        printk("error doevent_init(): kmalloc()\n");
+        return;
+    }
+
+    unsigned int i;
+    for (i = 0; i < buckets; i++) {
+        spin_lock_init(&(event_table[i].lock));
+        event_table[i].free_head = -1;
+        event_table[i].free_tail = -1;
+        event_table[i].nr_free = 0;
+        event_table[i].nr_slots = 0;
+        event_table[i].chunks = kzalloc((event_bucket_slots / EVENT_SLOT_CHUNK) * sizeof(struct event_slot *), GFP_KERNEL);
+        if (event_table[i].chunks == NULL) {
+            printk("error doevent_init(): kzalloc()\n");
+            return;
+        }
+    }
+
+    printk("doevent_init(): %u event table buckets of %u slots\n", buckets, event_bucket_slots);
+    event_initialized = true;
+}
+
+
+
+
+
+
+
+/*
+ * Create a new event of the given type, with the type's argument arg and flags, and assign an event ID to it.
+ * Add the new event to the event table.
+ * Return event id on success.
+ * Return -1, after printing an error naming the caller, on failure.
+ */
+static long event_create(int type, int arg, int flags, const char * caller)
+{
+    /* The wait queue comes initialized from the slab constructor. */
+    struct event * new_event = kmem_cache_alloc(event_cachep, GFP_KERNEL);
+    if (new_event == NULL) {
+        printk("error %s(): kmem_cache_alloc()\n", caller);
+        return -1;
+    }
+
+    /* A mailbox event owns a ring of arg messages. */
+    new_event->mailbox = NULL;
+    if (type == EVENT_TYPE_MAILBOX) {
+        new_event->mailbox = kmalloc(sizeof(struct event_mailbox) + arg * sizeof(u64), GFP_KERNEL);
+        if (new_event->mailbox == NULL) {
+            kmem_cache_free(event_cachep, new_event);
+            printk("error %s(): kmalloc()\n", caller);
+            return -1;
+        }
+        new_event->mailbox->capacity = arg;
+        new_event->mailbox->full_policy = flags & EVENT_MAILBOX_FULL_MASK;
+        new_event->mailbox->head = 0;
+        new_event->mailbox->count = 0;
+    }
+
+    /* Initialize attributes of new_event. */
+    new_event->UID = current->cred->euid;  
+    new_event->GID = current->cred->egid;
+    new_event->UIDFlag = 1;
+    new_event->GIDFlag = 1;
+//  new_event->wait_queue_lock = RW_LOCK_UNLOCKED;
+    
+    /* The event table holds the first reference. */
+    atomic_set(&(new_event->refcount), 1);
+    new_event->status = (type == EVENT_TYPE_AUTORESET && arg != 0) ? (1UL << EVENT_SIGNALED) : 0;
+    if (flags & EVENT_CREATE_ADAPTIVE) {
+        new_event->status |= (1UL << EVENT_ADAPTIVE);
+    }
+    new_event->signaler = NULL;
+    new_event->wake_affinity = EVENT_WAKE_DEFAULT;
+    new_event->word = NULL;
+    new_event->word_pin = NULL;
+    new_event->type = type;
+    new_event->seq = 0;
+    new_event->flag_state = 0;
+    atomic_set(&(new_event->count), (type == EVENT_TYPE_SEMAPHORE) ? arg : 0);
+    new_event->participants = (type == EVENT_TYPE_BARRIER) ? arg : 0;
+
+    /* Assign eventID to new_event and publish it. No duplicate! */
+    if (event_install(new_event) < 0) {
+        printk("error %s(): event table full\n", caller);
+        kfree(new_event->mailbox);
+        kmem_cache_free(event_cachep, new_event);
+        return -1;
+    }
+
+
+    return new_event->eventID;
+}
+
+
+
+
+
+
+
+/*
+ * Create a new event and assign an event ID to it.
+ * Add the new event to the event table.
+ * Return event id on success.
+ * Return -1 on failure.
+ */
+asmlinkage long sys_doeventopen()
+{
+
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventopen(): event not initialized\n");
+        return -1;
+    }
+
+    return event_create(EVENT_TYPE_NORMAL, 0, 0, __func__);
+}
+
+
+
+
+
+
+/*
+ * Wake up all tasks in the waiting queue of the event with given eventID.
+ * Remove the event from the event table.
+ * Free memory which hold the event.
+ * Return the number of processed signaled on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventclose(int eventID)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventclose(): event not initialized\n");
+        return -1;
+    }    
+
+
+    /* Search for event in event list. */
+    struct event * this_event = get_event(eventID);
+
+    /* If event not found. */
+    if (this_event == NULL) {
+        printk("error sys_doeventclose(): event not found. eventID = %d\n", eventID);
+        return -1;
+    }
+
+    /* Check accessibility. */
+    uid_t uid = current->cred->euid;
+    gid_t gid = current->cred->egid;
+    if (uid != 0 && (uid != this_event->UID || this_event->UIDFlag == 0) && (gid != this_event->GID || this_event->GIDFlag == 0)) {
+        put_event(this_event);
+        printk("sys_doeventclose(): access denied\n");
+        return -1;
+    }
+
+    /* Delete event from its slot. A racing close may have removed it since the lookup. */
+    if (event_uninstall(this_event) != 0) {
+        put_event(this_event);
+        printk("error sys_doeventclose(): event not found. eventID = %d\n", eventID);
+        return -1;
+    }
+
+
+    /*
+     * Mark the event closed under the wait queue lock, so a waiter either is already
+     * queued and gets woken below, or sees the bit and does not go to sleep.
+     */
+    unsigned long flags;
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    set_bit(EVENT_CLOSED, &(this_event->status));
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+
+    /*
+     * Wake up all tasks in the waiting queue of the event.
+     * Remove the tasks from the waiting queue.
+     */
+    int processes_signaled = event_signal(this_event);
+
+    /* Drop the table reference and ours. The last user frees the event. */
+    put_event(this_event);
+    put_event(this_event);
+    return processes_signaled;
+}
+
+
+
+
+
+
+/*
+ * Make the calling tasks wait in the wait queue of the event with the given eventID.
+ * Rreturn 0 on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwait(int eventID)
+{
+
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventwait(): event not initialized\n");
+        return -1;
+    }
+
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+
+    /* Interruptions are reported as success, as they always have been. */
+    event_do_wait(this_event, 0, NULL);
+    put_event(this_event);
+
+
+    return 0;
+}
+
+
+
+
+
+
+/*
+ * Wake up all tasks waiting in the event with the given event ID.
+ * Remove all tasks from waiting queue.
+ * Return the number of processes actually woken on success.
+ * Return -EOVERFLOW if a semaphore event would hold more than INT_MAX units, see doeventcreate.
+ * Return -EAGAIN if a mailbox event is full, or -EPIPE if it was closed, see doeventcreate.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventsig(int eventID)
+{
+
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventsig(): event not initialized\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+
+
+    /* Wake up tasks in the wait queue. */
+    int processes_signaled = event_do_signal(this_event, 0);
+    put_event(this_event);
+    
+
+    return processes_signaled;
+}
+
+
+
+
+/*
+ * If eventIDs != NULL && num >= event_count, copy all event IDs in ascending order to user array pointed to by eventIDs.
+ * If eventIDs == NULL || num < event_count, do not copy.
+ * Return the number of active events on success.
+ * Return -1 on failure.
+ */
+asmlinkage long sys_doeventinfo(int num, int * eventIDs)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventinfo(): event not initialized\n");
+        return -1;
+    }
+
+
+    /* Count events. */
+    int event_count = 0;
+    unsigned int bucket;
+    unsigned int slot;
+    struct event_slot * this_slot;
+    rcu_read_lock();
+    for (bucket = 0; bucket <= event_table_mask; bucket++) {
+        for (slot = 0; (this_slot = event_slot(&event_table[bucket], slot)) != NULL; slot++) {
+            if (rcu_dereference(this_slot->event) != NULL) {
+                event_count++;
+            }
+        }
+    }
+    rcu_read_unlock();
+
+        
+    /* Check arguments. */
+    if (num < event_count || eventIDs == NULL) {
+        return event_count;
+    }
+    
+
+    /* Kmalloc an array for storing event IDs. */
+    int * sys_eventIDs;
+    if ((sys_eventIDs = kmalloc(event_count * sizeof(int), GFP_KERNEL)) == NULL) {
+        printk("error sys_doeventinfo(): kmalloc()\n");
+        return -1;
+    }
+
+    /* Insert all event IDs to array pointed to by sys_eventIDs. Events opened since counting are left out. */
+    int i = 0;
+    struct event * pos;
+    rcu_read_lock();
+    for (bucket = 0; bucket <= event_table_mask && i < event_count; bucket++) {
+        for (slot = 0; i < event_count && (this_slot = event_slot(&event_table[bucket], slot)) != NULL; slot++) {
+            pos = rcu_dereference(this_slot->event);
+            if (pos != NULL) {
+                *(sys_eventIDs + i++) = pos->eventID;   
+            }
+        }
+    }
+    rcu_read_unlock();
+    event_count = i;
+
+    /* Report events in ascending ID order, independent of the bucket count. */
+    sort(sys_eventIDs, event_count, sizeof(int), event_ID_cmp, NULL);
+    
+
+    /* Copy to user. */
+    if (copy_to_user(eventIDs, sys_eventIDs, event_count * sizeof(int)) != 0) {
+        kfree(sys_eventIDs);
+        printk("error sys_doeventinfo(): copy_to_user()\n");
+        return -1;
+    }
+
+    kfree(sys_eventIDs);
+    
+    return event_count;
+}
+
+
+
+
+
+/*
+ * Change the UID and GID of the event with the given eventID to the given UID and GID.
+ * Return 0 on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && uid != event->UID
+ */
+asmlinkage long sys_doeventchown(int eventID, uid_t UID, gid_t GID)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventchown(): event not initialized\n");
+        return -1;
+    }
+
+
+    /*
+     * Search for the event in event list.
+     * No reference is taken, so chown writes only the line of the permission metadata,
+     * not the reference count next to the wait queue lock. RCU keeps the event's memory alive.
+     */
+    rcu_read_lock();
+    struct event * this_event = __get_event(eventID);
+    
+    /* If event not found. */
+    if (this_event == NULL) {
+        rcu_read_unlock();
+        printk("error sys_doeventchown(): event not found. eventID = %d\n", eventID);
+        return -1;
+    }
+
+
+    /* Check accessibility. */
+    uid_t uid = current->cred->euid;
+    if (uid != 0 && uid != this_event->UID) {
+        rcu_read_unlock();
+        printk("sys_doeventchown(): access denied\n");
+        return -1;
+    }
+
+
+
+    this_event->UID = UID;
+    this_event->GID = GID;
+    rcu_read_unlock();
+
+    return 0;
+}
+
+
+
+
+
+/*
+ * Change event->UIDFlag to UIDFlag and event->GIDFlag to GIDFlag.
+ * Return 0 on success.
+ * Retutn -1 on failure.
+ * Access denied:
+ *  uid != 0 && uid != event->UID
+ */
+asmlinkage long sys_doeventchmod(int eventID, int UIDFlag, int GIDFlag)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventchmod(): event not initialized\n");
+        return -1;
+    }
+
+    /* Check arguments. */
+    if (UIDFlag < 0 || UIDFlag > 1 || GIDFlag < 0 || GIDFlag > 1) {
+        printk("error sys_doeventchmod(): invalid arguments\n");
+        return -1;
+    }
+
+    /* Search for the event in event list. Like chown, without a reference. */    
+    rcu_read_lock();
+    struct event * this_event = __get_event(eventID);
+
+    /* If event not found. */
+    if (this_event == NULL) {
+        rcu_read_unlock();
+        printk("error sys_doeventchmod(): event not found. eventID = %d\n", eventID);
+        return -1;
+    }
+
+    /* Check accessibility. */
+    uid_t uid = current->cred->euid;
+    if (uid != 0 && uid != this_event->UID) {
+        rcu_read_unlock();
+        printk("sys_doeventchmod(): access denied\n");
+        return -1;
+    }
+
+    this_event->UIDFlag = UIDFlag;
+    this_event->GIDFlag = GIDFlag;
+    rcu_read_unlock();
+
+    return 0;
+}
+
+
+
+
+
+/*
+ * Place the UID, GID, User Signal Enable Bit and Group Signal Enable Bit into the memory pointed to by UID, GID, UIDFlag and GIDFlag respectively.
+ * Return 0 on success.
+ * Return -1 on filure.
+ */
+asmlinkage long sys_doeventstat(int eventID, uid_t * UID, gid_t * GID, int * UIDFlag, int * GIDFlag)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventstat(): event not initialized\n");
+        return -1;
+    }
+
+    /* Check arguments. */
+    if (UID == NULL || GID == NULL || UIDFlag == NULL || GIDFlag == NULL) {
+        printk("error sys_doeventstat(): invalid eventID\n");
+        return -1;
+    }
+
+    /* Search for the event in event list. Like chown, without a reference. */
+    rcu_read_lock();
+    struct event * this_event = __get_event(eventID); 
+
+    /* If event not found. */
+    if (this_event == NULL) {
+        rcu_read_unlock();
+        printk("error sys_doeventstat(): event not found. eventID = %d\n", eventID);
+        return -1;
+    }
+
+    /* Snapshot the attributes and leave the read-side section before copying to user space. */
+    uid_t event_UID = this_event->UID;
+    gid_t event_GID = this_event->GID;
+    int event_UIDFlag = this_event->UIDFlag;
+    int event_GIDFlag = this_event->GIDFlag;
+    rcu_read_unlock();
+
+
+    if (copy_to_user(UID, &event_UID, sizeof(uid_t)) != 0) {
+        printk("error sys_doeventstat(): copy_to_user()\n");
+        return -1;
+    }
+
+    if (copy_to_user(GID, &event_GID, sizeof(gid_t)) != 0) {
+        printk("error sys_doeventstat(): copy_to_user()\n");
+        return -1;
+    }
+
+    if (copy_to_user(UIDFlag, &event_UIDFlag, sizeof(int)) != 0) {
+        printk("error sys_doeventstat(): copy_to_user()\n");
+        return -1;
+    }
+
+    if (copy_to_user(GIDFlag, &event_GIDFlag, sizeof(int)) != 0) {
+        printk("error sys_doeventstat(): copy_to_user()\n");
+        return -1;
+    }
+
+
+    return 0;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait exclusively in the wait queue of the event with the given eventID.
+ * Exclusive waiters are released one at a time by doeventsigone, and all at once by doeventsig and doeventclose.
+ * Return 0 on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitexcl(int eventID)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventwaitexcl(): event not initialized\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+
+    event_do_wait(this_event, 1, NULL);
+    put_event(this_event);
+
+    return 0;
+}
+
+
+
+
+
+/*
+ * Wake up one exclusive waiter of the event with the given event ID, along with any non-exclusive waiters.
+ * Return the number of processes actually woken on success.
+ * Return -EOVERFLOW if a semaphore event would hold more than INT_MAX units, see doeventcreate.
+ * Return -EAGAIN if a mailbox event is full, or -EPIPE if it was closed, see doeventcreate.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventsigone(int eventID)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventsigone(): event not initialized\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+
+    int processes_signaled = event_do_signal(this_event, 1);
+    put_event(this_event);
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+/*
+ * Wake up to nr exclusive waiters of the event with the given event ID, along with any non-exclusive waiters.
+ * Return the number of processes actually woken on success.
+ * Return -EOVERFLOW if a semaphore event would hold more than INT_MAX units, see doeventcreate.
+ * Return -EAGAIN if a mailbox event is full, or -EPIPE if it was closed, see doeventcreate.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventsign(int eventID, int nr)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventsign(): event not initialized\n");
+        return -1;
+    }
+
+    /* Check arguments. */
+    if (nr < 1) {
+        printk("error sys_doeventsign(): invalid arguments\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+
+    int processes_signaled = event_do_signal(this_event, nr);
+    put_event(this_event);
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+/*
+ * Make the calling task wait in the wait queue of the event with the given eventID, for at most the given time.
+ * timeout is relative, or an absolute CLOCK_MONOTONIC time if flags has EVENT_WAIT_ABSTIME.
+ * With EVENT_WAIT_EXCLUSIVE the caller waits exclusively, as with doeventwaitexcl.
+ * Return 0 if signaled.
+ * Return -ETIMEDOUT if the timeout expired first.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventtimedwait(int eventID, struct timespec * timeout, int flags)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventtimedwait(): event not initialized\n");
+        return -1;
+    }
+
+    /* Check arguments. */
+    if (timeout == NULL || (flags & ~(EVENT_WAIT_ABSTIME | EVENT_WAIT_EXCLUSIVE)) != 0) {
+        printk("error sys_doeventtimedwait(): invalid arguments\n");
+        return -1;
+    }
+
+    ktime_t expires;
+    if (event_timeout_to_deadline(timeout, flags, &expires, __func__) != 0) {
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+
+    long ret = event_do_wait(this_event, (flags & EVENT_WAIT_EXCLUSIVE) != 0, &expires);
+    put_event(this_event);
+
+    return ret;
+}
+
+
+
+
+
+
+/*
+ * Release the waiters and the event references set up by get_events_wait().
+ */
+static void put_events_wait(int num, struct event_waiter * waiters, struct event ** events)
+{
+    int i;
+    for (i = 0; i < num; i++) {
+        put_event(events[i]);
+    }
+    kfree(waiters);
+}
+
+
+
+
+
+
+
+/*
+ * Set up a wait on the num events with the IDs in the user array eventIDs, for doeventwaitv and doeventwaitall.
+ * On success, return 0 with *waiters pointing to num waiters followed by the num looked up events in *events,
+ * each holding a reference. Release them with put_events_wait().
+ * Return -1, after printing an error naming the caller, on failure.
+ */
+static int get_events_wait(int num, int * eventIDs, struct event_waiter ** waiters, struct event *** events, const char * caller)
+{
+    /* One allocation for the waiters, the events and the IDs, in order of decreasing alignment. */
+    *waiters = kmalloc(num * (sizeof(struct event_waiter) + sizeof(struct event *) + sizeof(int)), GFP_KERNEL);
+    if (*waiters == NULL) {
+        printk("error %s(): kmalloc()\n", caller);
+        return -1;
+    }
+    *events = (struct event **) (*waiters + num);
+    int * sys_eventIDs = (int *) (*events + num);
+
+    if (copy_from_user(sys_eventIDs, eventIDs, num * sizeof(int)) != 0) {
+        kfree(*waiters);
+        printk("error %s(): copy_from_user()\n", caller);
+        return -1;
+    }
+
+    /* Search for all events and check accessibility in one go. */
+    if (get_events_access(sys_eventIDs, num, *events, caller) != 0) {
+        kfree(*waiters);
+        return -1;
+    }
+
+    int i;
+    for (i = 0; i < num; i++) {
+        if (!event_check_normal((*events)[i], caller)) {
+            put_events_wait(num, *waiters, *events);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait on all num events with the IDs in the user array eventIDs, until any of them is signaled or closed.
+ * If timeout is not NULL, wait for at most that time, which is relative or, with EVENT_WAIT_ABSTIME in flags, an absolute CLOCK_MONOTONIC time.
+ * num must be between 1 and EVENT_WAITV_MAX.
+ * Return the index in eventIDs of the event that fired. If several fired, the lowest index.
+ * Return -ETIMEDOUT if the timeout expired first.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied on any of the events:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitv(int num, int * eventIDs, struct timespec * timeout, int flags)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventwaitv(): event not initialized\n");
+        return -1;
+    }
+
+    /* Check arguments. */
+    if (num < 1 || num > EVENT_WAITV_MAX || eventIDs == NULL || (flags & ~EVENT_WAIT_ABSTIME) != 0) {
+        printk("error sys_doeventwaitv(): invalid arguments\n");
+        return -1;
+    }
+
+    ktime_t expires;
+    if (timeout != NULL && event_timeout_to_deadline(timeout, flags, &expires, __func__) != 0) {
+        return -1;
+    }
+
+    struct event_waiter * waiters;
+    struct event ** events;
+    if (get_events_wait(num, eventIDs, &waiters, &events, __func__) != 0) {
+        return -1;
+    }
+
+    long ret = event_wait_any(events, waiters, num, 0, (timeout != NULL) ? &expires : NULL);
+
+    put_events_wait(num, waiters, events);
+
+    return ret;
+}
+
+
+
+
+
+
+/*
+ * Make the calling task wait on all num events with the IDs in the user array eventIDs, until every one of them has been signaled or closed since the call began.
+ * If timeout is not NULL, wait for at most that time, which is relative or, with EVENT_WAIT_ABSTIME in flags, an absolute CLOCK_MONOTONIC time.
+ * num must be between 1 and EVENT_WAITV_MAX.
+ * If fired is not NULL, fill the user array fired, of num ints, with 1 for each event that fired and 0 for the others, also on timeout or interruption.
+ * Return 0 if all events fired.
+ * Return -ETIMEDOUT if the timeout expired first.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied on any of the events:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitall(int num, int * eventIDs, int * fired, struct timespec * timeout, int flags)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventwaitall(): event not initialized\n");
+        return -1;
+    }
+
+    /* Check arguments. */
+    if (num < 1 || num > EVENT_WAITV_MAX || eventIDs == NULL || (flags & ~EVENT_WAIT_ABSTIME) != 0) {
+        printk("error sys_doeventwaitall(): invalid arguments\n");
+        return -1;
+    }
+
+    ktime_t expires;
+    if (timeout != NULL && event_timeout_to_deadline(timeout, flags, &expires, __func__) != 0) {
+        return -1;
+    }
+
+    struct event_waiter * waiters;
+    struct event ** events;
+    if (get_events_wait(num, eventIDs, &waiters, &events, __func__) != 0) {
+        return -1;
+    }
+
+    long ret = event_wait_all(events, waiters, num, (timeout != NULL) ? &expires : NULL);
+
+    /* Report which events fired, reusing the ID array behind events. */
+    if (fired != NULL) {
+        int * sys_fired = (int *) (events + num);
+        int i;
+        for (i = 0; i < num; i++) {
+            sys_fired[i] = event_fired(events[i], &waiters[i]) ? 1 : 0;
+        }
+        if (copy_to_user(fired, sys_fired, num * sizeof(int)) != 0) {
+            printk("error sys_doeventwaitall(): copy_to_user()\n");
+            ret = -1;
+        }
+    }
+
+    put_events_wait(num, waiters, events);
+
+    return ret;
+}
+
+
+
+
+
+
+/*
+ * Set the event with the given event ID, and wake up all tasks waiting in it.
+ * The event stays set until doeventreset, and waits on it return immediately in the meantime.
+ * Return the number of processes actually woken on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventset(int eventID)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventset(): event not initialized\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
+        return -1;
+    }
+
+    /*
+     * Set the bit under the wait queue lock, so a waiter either is already
+     * queued and gets woken below, or sees the bit and does not go to sleep.
+     */
+    unsigned long flags;
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    set_bit(EVENT_SIGNALED, &(this_event->status));
+    if (this_event->word != NULL) {
+        event_word_or(this_event->word, EVENT_WORD_SIGNALED);
+    }
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+
+    /* Wake up tasks in the wait queue. */
+    int processes_signaled = event_signal(this_event);
+    put_event(this_event);
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+
+/*
+ * Reset the event with the given event ID, so waits on it block again.
+ * Return 0 on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventreset(int eventID)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventreset(): event not initialized\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+
+    clear_bit(EVENT_SIGNALED, &(this_event->status));
+    if (this_event->word != NULL) {
+        event_word_andnot(this_event->word, EVENT_WORD_SIGNALED);
+    }
+    put_event(this_event);
+
+    return 0;
+}
+
+
+
+
+
+
+
+/*
+ * Wake up all tasks waiting in the event with the given event ID, and leave the event reset.
+ * Unlike doeventsig, this also clears a set made by doeventset.
+ * Return the number of processes actually woken on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventpulse(int eventID)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventpulse(): event not initialized\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
+        return -1;
+    }
+
+    clear_bit(EVENT_SIGNALED, &(this_event->status));
+    if (this_event->word != NULL) {
+        event_word_andnot(this_event->word, EVENT_WORD_SIGNALED);
+    }
+
+    /* Wake up tasks in the wait queue. */
+    int processes_signaled = event_signal(this_event);
+    put_event(this_event);
+
+    return processes_signaled;
+}
+
+
+
+
+
+
+/*
+ * Return the signal sequence number of the event with the given event ID on success.
+ * Every signal of the event, including a close, increments it.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventseq(int eventID)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventseq(): event not initialized\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+
+    unsigned int seq = ACCESS_ONCE(this_event->seq);
+    put_event(this_event);
+
+    return seq;
+}
+
+
+
+
+
+
+
+/*
+ * Make the calling task wait in the event with the given event ID, if its signal sequence number still equals seq.
+ * The compare and the queueing are atomic with respect to signals, so a signal after reading seq is never missed.
+ * Return 0 if signaled, set or closed.
+ * Return -EAGAIN if the sequence number differs from seq.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitseq(int eventID, unsigned int seq)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventwaitseq(): event not initialized\n");
+        return -1;
+    }
+
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
+        return -1;
+    }
+
+    long ret = event_wait_seq(this_event, seq);
+    put_event(this_event);
+
+    return ret;
+}
+
+
+
+
+
+
+/*
+ * Create a new event of the given type and assign an event ID to it, like doeventopen.
+ * EVENT_TYPE_NORMAL: arg must be 0.
+ * EVENT_TYPE_SEMAPHORE: arg is the initial number of units, at least 0.
+ *  doeventsig and doeventsigone add one unit and doeventsign adds nr, waking as many waiters.
+ *  doeventwait, doeventwaitexcl and doeventtimedwait take one unit, and block while there is none.
+ *  Units accumulate while nobody waits, up to INT_MAX. A signal that would go past it adds nothing and fails with -EOVERFLOW.
+ * EVENT_TYPE_AUTORESET: arg is 1 to create the event set, or 0.
+ *  doeventsig, doeventsigone and doeventsign set the event, and wake one waiter.
+ *  doeventwait, doeventwaitexcl and doeventtimedwait block until the event is set, and reset it on the way out,
+ *  so each set lets exactly one waiter through. doeventreset resets the event.
+ * EVENT_TYPE_BARRIER: arg is the number of participants, at least 1.
+ *  doeventwait, doeventwaitexcl and doeventtimedwait arrive at the barrier, and block until the last participant
+ *  arrives, which releases them all at once and re-arms the barrier for the next phase.
+ *  doeventsig, doeventsigone and doeventsign release the waiting participants early.
+ *  A participant that times out or is interrupted before the release no longer counts as arrived.
+ * EVENT_TYPE_MAILBOX: arg is the capacity of the message queue, from 1 to EVENT_MAILBOX_MAX_CAPACITY.
+ *  doeventsigval enqueues a 64-bit message and wakes one receiver, and doeventwaitval dequeues one, blocking while
+ *  there is none. doeventsig and doeventsigone enqueue a 0 message, doeventsign enqueues nr of them, up to the capacity,
+ *  and the other waits discard one. These plain signals never wait for room: on a full queue they fail with -EAGAIN,
+ *  unless the policy is EVENT_MAILBOX_FULL_OVERWRITE. doeventsign stops at the first message it cannot enqueue,
+ *  and fails only if it enqueued none.
+ *  flags picks what a doeventsigval to a full queue does: EVENT_MAILBOX_FULL_BLOCK waits for room,
+ *  EVENT_MAILBOX_FULL_FAIL returns -EAGAIN and EVENT_MAILBOX_FULL_OVERWRITE drops the oldest message.
+ *  Once closed, receivers drain the queued messages, then get -EPIPE, as do senders.
+ * flags must be 0 for other types, apart from EVENT_CREATE_ADAPTIVE, which any type takes.
+ * With EVENT_CREATE_ADAPTIVE, non-exclusive doeventwait and doeventtimedwait calls on an EVENT_TYPE_NORMAL event
+ * spin for up to the "eventspin=" boot time, never past their timeout, before sleeping, while the last task to signal the event runs on a CPU.
+ * Return event id on success.
+ * Return -1 on failure.
+ */
+asmlinkage long sys_doeventcreate(int type, int arg, int flags)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventcreate(): event not initialized\n");
+        return -1;
+    }
+
+    /* Check arguments. Apart from EVENT_CREATE_ADAPTIVE, only mailbox events take flags. */
+    int type_flags = flags & ~EVENT_CREATE_ADAPTIVE;
+    if (type_flags != 0 && (type != EVENT_TYPE_MAILBOX || (type_flags & ~EVENT_MAILBOX_FULL_MASK) != 0 || type_flags == EVENT_MAILBOX_FULL_MASK)) {
+        printk("error sys_doeventcreate(): invalid arguments\n");
+        return -1;
+    }
+    switch (type) {
+    case EVENT_TYPE_NORMAL:
+        if (arg != 0) {
+            printk("error sys_doeventcreate(): invalid arguments\n");
+            return -1;
+        }
+        break;
+    case EVENT_TYPE_SEMAPHORE:
+        if (arg < 0) {
+            printk("error sys_doeventcreate(): invalid arguments\n");
+            return -1;
+        }
+        break;
+    case EVENT_TYPE_AUTORESET:
+        if (arg != 0 && arg != 1) {
+            printk("error sys_doeventcreate(): invalid arguments\n");
+            return -1;
+        }
+        break;
+    case EVENT_TYPE_BARRIER:
+        if (arg < 1) {
+            printk("error sys_doeventcreate(): invalid arguments\n");
+            return -1;
+        }
+        break;
+    case EVENT_TYPE_MAILBOX:
+        if (arg < 1 || arg > EVENT_MAILBOX_MAX_CAPACITY) {
+            printk("error sys_doeventcreate(): invalid arguments\n");
+            return -1;
+        }
+        break;
+    default:
+        printk("error sys_doeventcreate(): invalid event type %d\n", type);
+        return -1;
+    }
+
+    return event_create(type, arg, flags, __func__);
+}
+
+
+
+
+
+
+/*
+ * Make the calling task wait in the event with the given event ID until it is signaled with a fire mask that
+ * intersects the given interest mask, or set or closed. doeventsig and other unmasked signals fire all bits.
+ * mask must not be 0.
+ * Return 0 if signaled, set or closed.
+ * Return -EINTR if interrupted by a signal first.
  * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
  */
-asmlinkage long sys_doeventopen()
+asmlinkage long sys_doeventwaitmask(int eventID, unsigned int mask)
 {
-
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
-        printk("error sys_doeventopen(): event not initialized\n");
+        printk("error sys_doeventwaitmask(): event not initialized\n");
         return -1;
     }
 
-    struct event * new_event = kmalloc(sizeof(struct event), GFP_KERNEL);
-
-    /* Initialize attributes of new_event. */
-    new_event->UID = current->cred->euid;  
-    new_event->GID = current->cred->egid;
-    new_event->UIDFlag = 1;
-    new_event->GIDFlag = 1;
-//  new_event->wait_queue_lock = RW_LOCK_UNLOCKED;
-    
-    /* Initialize event list entry. */
-    INIT_LIST_HEAD(&(new_event->eventID_list));
+    /* Check arguments. */
+    if (mask == 0) {
+        printk("error sys_doeventwaitmask(): invalid arguments\n");
+        return -1;
+    }
 
-    unsigned long flags;
-    /* Lock write on event list. */
-    write_lock_irqsave(&eventID_list_lock, flags);
-    /* Add new_event to the tail of event list. */
-    list_add_tail(&(new_event->eventID_list), &global_event.eventID_list);
-    /* Find immediate preceding event's ID. */
-    int max_id = list_entry((new_event->eventID_list).prev, struct event, eventID_list)->eventID;
-    /* Assign eventID to new_event. No duplicate! */
-    new_event->eventID = max_id + 1;
-    /* Initialize wait queue. */
-    init_waitqueue_head(&(new_event->wait_queue)); 
-    write_unlock_irqrestore(&eventID_list_lock, flags);
-    /* Write unlocked on event list. */
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
+    }
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
+        return -1;
+    }
 
+    long ret = event_wait_mask(this_event, mask);
+    put_event(this_event);
 
-    return new_event->eventID;
+    return ret;
 }
 
 
@@ -147,64 +3120,44 @@ asmlinkage long sys_doeventopen()
 
 
 
+
 /*
- * Wake up all tasks in the waiting queue of the event with given eventID.
- * Remove the event from global event list.
- * Free memory which hold the event.
- * Return the number of processed signaled on success.
+ * Wake up the tasks waiting in the event with the given event ID whose interest mask intersects the given fire mask.
+ * Waiters that did not pass an interest mask match any fire mask.
+ * mask must not be 0.
+ * Return the number of processes actually woken on success.
  * Return -1 on failure.
  * Access denied:
  *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
  */
-asmlinkage long sys_doeventclose(int eventID)
+asmlinkage long sys_doeventsigmask(int eventID, unsigned int mask)
 {
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
-        printk("error sys_doeventclose(): event not initialized\n");
+        printk("error sys_doeventsigmask(): event not initialized\n");
         return -1;
-    }    
-
+    }
 
-    unsigned long flags;
-    /* Lock read. */
-    read_lock_irqsave(&eventID_list_lock, flags);
-    /* Search for event in event list. */
-    struct event * this_event = get_event(eventID);
-    read_unlock_irqrestore(&eventID_list_lock, flags);
-    /* Read unlocked. */
+    /* Check arguments. */
+    if (mask == 0) {
+        printk("error sys_doeventsigmask(): invalid arguments\n");
+        return -1;
+    }
 
-    
-    /* If event not found. */
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
     if (this_event == NULL) {
-        printk("error sys_doeventclose(): event not found. eventID = %d\n", eventID);
         return -1;
     }
-
-    /* Check accessibility. */
-    uid_t uid = current->cred->euid;
-    gid_t gid = current->cred->egid;
-    if (uid != 0 && (uid != this_event->UID || this_event->UIDFlag == 0) && (gid != this_event->GID || this_event->GIDFlag == 0)) {
-        printk("sys_doeventclose(): access denied\n");
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
         return -1;
     }
 
+    struct event_wake_key key = { .mask = mask, .value = 0 };
+    int processes_signaled = event_signal_key(this_event, &key);
+    put_event(this_event);
 
-    /*
-     * Wake up all tasks in the waiting queue of the event.
-     * Remove the tasks from the waiting queue.
-     */
-    int processes_signaled = sys_doeventsig(eventID);
-
-   
-    /* Lock write. */
-    write_lock_irqsave(&eventID_list_lock, flags);
-    /* Delete event from event list. */
-    list_del(&(this_event->eventID_list));
-    write_unlock_irqrestore(&eventID_list_lock, flags);
-    /* Write unlocked. */
-
-    /* Remember to free memory. */
-    kfree(this_event);
     return processes_signaled;
 }
 
@@ -214,64 +3167,47 @@ asmlinkage long sys_doeventclose(int eventID)
 
 
 /*
- * Make the calling tasks wait in the wait queue of the event with the given eventID.
- * Rreturn 0 on success.
+ * Set the given flag bits of the event with the given event ID, and wake up the doeventflagwait waiters whose condition now holds.
+ * Other waiters are not woken, and the signal sequence number is unchanged.
+ * bits must not be 0.
+ * Return the number of processes actually woken on success.
  * Return -1 on failure.
  * Access denied:
  *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
  */
-asmlinkage long sys_doeventwait(int eventID)
+asmlinkage long sys_doeventflagset(int eventID, unsigned int bits)
 {
-
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
-        printk("error sys_doeventwait(): event not initialized\n");
+        printk("error sys_doeventflagset(): event not initialized\n");
         return -1;
     }
 
+    /* Check arguments. */
+    if (bits == 0) {
+        printk("error sys_doeventflagset(): invalid arguments\n");
+        return -1;
+    }
 
-    unsigned long flags;
-    /* Lock read. */
-    read_lock_irqsave(&eventID_list_lock, flags);
-    /* Search for the event in the event list. */
-    struct event * this_event = get_event(eventID);
-    read_unlock_irqrestore(&eventID_list_lock, flags);
-    /* Read unlocked. */
-
-    /* If event not found. */
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
     if (this_event == NULL) {
-        printk("error sys_doeventwait(): event not found. eventID = %d\n", eventID);
         return -1;
     }
-
-
-    /* Check accessibility. */
-    uid_t uid = current->cred->euid;
-    gid_t gid = current->cred->egid;
-    if (uid != 0 && (uid != this_event->UID || this_event->UIDFlag == 0) && (gid != this_event->GID || this_event->GIDFlag == 0)) {
-        printk("sys_doeventwait(): access denied\n");
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
         return -1;
     }
 
-    
-
-    DEFINE_WAIT(wait);
-    /* 
-     * Lock wait_queue so that no other process can wait on or wake up the wait queue,
-     * until this process has changed its status.
-     */
-    /* Change task status to either TASK_INTERRUPTIBLE or TASK_UNINTERRUPTIBLE. */
-    prepare_to_wait(&(this_event->wait_queue), &wait, TASK_INTERRUPTIBLE);
-    /* 
-     * Wait queue has been unlocked.
-     * Other process can wait on this queue or wake up tasks on this queue.
-     */
-
-    schedule();
-    finish_wait(&(this_event->wait_queue), &wait);
-
+    /* Set the bits and wake the satisfied waiters in one critical section. */
+    unsigned long flags;
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    this_event->flag_state |= bits;
+    int processes_signaled = __event_flags_wake(this_event);
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+    put_event(this_event);
 
-    return 0;
+    return processes_signaled;
 }
 
 
@@ -279,230 +3215,196 @@ asmlinkage long sys_doeventwait(int eventID)
 
 
 
+
 /*
- * Wake up all tasks waiting in the event with the given event ID.
- * Remove all tasks from waiting queue.
- * Return the number of processes signaled on success.
+ * Clear the given flag bits of the event with the given event ID.
+ * Return the flag bits from before the clear on success.
  * Return -1 on failure.
  * Access denied:
  *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
  */
-asmlinkage long sys_doeventsig(int eventID)
+asmlinkage long sys_doeventflagclear(int eventID, unsigned int bits)
 {
-
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
-        printk("error sys_doeventsig(): event not initialized\n");
+        printk("error sys_doeventflagclear(): event not initialized\n");
         return -1;
     }
 
-    unsigned long flags;
-    /* Lock read. */
-    read_lock_irqsave(&eventID_list_lock, flags);
-    /* Search for the event in the event list. */
-    struct event * this_event = get_event(eventID);
-    read_unlock_irqrestore(&eventID_list_lock, flags);
-    /* Read unlocked. */
-    
-
-
-    /* If event not found. */
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
     if (this_event == NULL) {
-        printk("error sys_doeventsig(): event not found. eventID = %d\n", eventID);
         return -1;
     }
-
-
-
-    /* Check accessibility. */
-    uid_t uid = current->cred->euid;
-    gid_t gid = current->cred->egid;
-    if (uid != 0 && (uid != this_event->UID || this_event->UIDFlag == 0) && (gid != this_event->GID || this_event->GIDFlag == 0)) {
-        printk("sys_doeventsig(): access denied\n");
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
         return -1;
     }
 
-
-    /* Lock wait queue. */
+    unsigned long flags;
     spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
-    /* Get the number of processes waiting on this event. */
-    int processes_signaled = get_list_length(&(this_event->wait_queue.task_list));
-    /* Unlock wait queue. */
+    unsigned int state = this_event->flag_state;
+    this_event->flag_state &= ~bits;
     spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
-    
-    /* Wake up tasks in the wait queue. */
-    wake_up(&(this_event->wait_queue));
-    
+    put_event(this_event);
 
-    return processes_signaled;
+    return state;
 }
 
 
 
 
+
+
+
 /*
- * If eventIDs != NULL && num >= event_count, copy all event IDs to user array pointed to by eventIDs.
- * If eventIDs == NULL || num < event_count, do not copy.
- * Return the number of active events on success.
+ * Make the calling task wait until any of the given flag bits of the event with the given event ID are set,
+ * or all of them if flags has EVENT_FLAG_ALL. Return at once if they already are.
+ * With EVENT_FLAG_CLEAR in flags, the requested bits are cleared as the wait is satisfied.
+ * bits must not be 0.
+ * Return the flag bits that satisfied the wait, from before any clearing, on success.
+ * Return 0 if the event was closed.
+ * Return -EINTR if interrupted by a signal first.
  * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
  */
-asmlinkage long sys_doeventinfo(int num, int * eventIDs)
+asmlinkage long sys_doeventflagwait(int eventID, unsigned int bits, int flags)
 {
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
-        printk("error sys_doeventinfo(): event not initialized\n");
+        printk("error sys_doeventflagwait(): event not initialized\n");
         return -1;
     }
 
-
-    unsigned long flags;
-    /* Lock read. */
-    read_lock_irqsave(&eventID_list_lock, flags);
-    /* Count events. */
-    int event_count = get_list_length(&global_event.eventID_list);
-
-    /* Kmalloc an array for storing event IDs. */
-    int * sys_eventIDs;
-    if ((sys_eventIDs = kmalloc(event_count * sizeof(int), GFP_KERNEL)) == NULL) {
-        printk("error sys_doeventinfo(): kmalloc()\n");
+    /* Check arguments. */
+    if (bits == 0 || (flags & ~(EVENT_FLAG_ALL | EVENT_FLAG_CLEAR)) != 0) {
+        printk("error sys_doeventflagwait(): invalid arguments\n");
         return -1;
     }
 
-    /* Insert all event IDs to array pointed to by sys_eventIDs. */
-    int i = 0;
-    struct event * pos; 
-     
-    list_for_each_entry(pos, &global_event.eventID_list, eventID_list) {    
-            
-        /* Do not insert or count global_event whose eventID is 0. */
-        if ((pos->eventID) != 0) {  
-            *(sys_eventIDs + i++) = pos->eventID;   
-        }
-    }
-
-    read_unlock_irqrestore(&eventID_list_lock, flags);
-    /* Read unlocked. */
-
-    
-    
-        
-    /* Check arguments. */
-    if (num < event_count || eventIDs == NULL) {
-        kfree(sys_eventIDs);
-        return event_count;
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
+    if (this_event == NULL) {
+        return -1;
     }
-    
-    
-
-    /* Copy to user. */
-    if (copy_to_user(eventIDs, sys_eventIDs, event_count * sizeof(int)) != 0) {
-        printk("error sys_doeventinfo(): copy_to_user()\n");
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
         return -1;
     }
 
-    kfree(sys_eventIDs);
-    
-    return event_count;
+    long ret = event_flag_wait(this_event, bits, flags);
+    put_event(this_event);
+
+    return ret;
 }
 
 
 
 
 
+
 /*
- * Change the UID and GID of the event with the given eventID to the given UID and GID.
- * Return 0 on success.
+ * Wake up all tasks waiting in the event with the given event ID, and deliver the given value to each of them.
+ * For a mailbox event, enqueue the value as a message for one receiver instead, see doeventcreate.
+ * Return the number of processes actually woken on success.
+ * Return -EAGAIN if a mailbox event is full and its policy is EVENT_MAILBOX_FULL_FAIL.
+ * Return -EPIPE if a mailbox event was closed.
+ * Return -EINTR if interrupted by a signal while waiting for room in a mailbox event.
  * Return -1 on failure.
  * Access denied:
- *  uid != 0 && uid != event->UID
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
  */
-asmlinkage long sys_doeventchown(int eventID, uid_t UID, gid_t GID)
+asmlinkage long sys_doeventsigval(int eventID, u64 value)
 {
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
-        printk("error sys_doeventchown(): event not initialized\n");
+        printk("error sys_doeventsigval(): event not initialized\n");
         return -1;
     }
 
-
-    unsigned long flags;
-    /* Lock Read. */
-    read_lock_irqsave(&eventID_list_lock, flags);
-     /* Search for the event in event list. */
-    struct event * this_event = get_event(eventID);
-    read_unlock_irqrestore(&eventID_list_lock, flags);
-    /* Read unlocked. */
-    
-    /* If event not found. */
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
     if (this_event == NULL) {
-        printk("error sys_doeventchown(): event not found. eventID = %d\n", eventID);
         return -1;
     }
 
-
-    /* Check accessibility. */
-    uid_t uid = current->cred->euid;
-    if (uid != 0 && uid != this_event->UID) {
-        printk("sys_doeventchown(): access denied\n");
+    /* A mailbox event queues the value for one receiver. */
+    if (this_event->type == EVENT_TYPE_MAILBOX) {
+        long ret = event_mbox_send(this_event, value, 0);
+        put_event(this_event);
+        return ret;
+    }
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
         return -1;
     }
 
+    struct event_wake_key key = { .mask = EVENT_MASK_ALL, .value = value };
+    int processes_signaled = event_signal_key(this_event, &key);
+    put_event(this_event);
 
+    return processes_signaled;
+}
 
-    this_event->UID = UID;
-    this_event->GID = GID;
 
-    return 0;
-}
 
 
 
 
 
 /*
- * Change event->UIDFlag to UIDFlag and event->GIDFlag to GIDFlag.
- * Return 0 on success.
- * Retutn -1 on failure.
+ * Make the calling task wait in the event with the given event ID, and store in value the value of the signal that woke it.
+ * The value is 0 if the task was woken by a signal without a value, by a set or by a close.
+ * For a mailbox event, dequeue the oldest message into value instead, waiting while there is none.
+ * Return 0 if signaled, set or closed, or a message was received.
+ * Return -EPIPE if a mailbox event was closed and has no messages left.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
  * Access denied:
- *  uid != 0 && uid != event->UID
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
  */
-asmlinkage long sys_doeventchmod(int eventID, int UIDFlag, int GIDFlag)
+asmlinkage long sys_doeventwaitval(int eventID, u64 * value)
 {
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
-        printk("error sys_doeventchmod(): event not initialized\n");
+        printk("error sys_doeventwaitval(): event not initialized\n");
         return -1;
     }
 
     /* Check arguments. */
-    if (UIDFlag < 0 || UIDFlag > 1 || GIDFlag < 0 || GIDFlag > 1) {
-        printk("error sys_doeventchmod(): invalid arguments\n");
+    if (value == NULL) {
+        printk("error sys_doeventwaitval(): invalid arguments\n");
         return -1;
     }
 
-    unsigned long flags;   
-    /* Lock read. */    
-    read_lock_irqsave(&eventID_list_lock, flags);
-    /* Search for the event in event list. */    
-    struct event * this_event = get_event(eventID);
-    read_unlock_irqrestore(&eventID_list_lock, flags);
-    /* Read unlocked. */
-
-    /* If event not found. */
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
     if (this_event == NULL) {
-        printk("error sys_doeventchmod(): event not found. eventID = %d\n", eventID);
         return -1;
     }
 
-    /* Check accessibility. */
-    uid_t uid = current->cred->euid;
-    if (uid != 0 && uid != this_event->UID) {
-        printk("sys_doeventchmod(): access denied\n");
-        return -1;
+    /* A mailbox event hands out its oldest message. */
+    u64 sys_value;
+    long ret;
+    if (this_event->type == EVENT_TYPE_MAILBOX) {
+        ret = event_mbox_receive(this_event, &sys_value, NULL);
+    } else if (event_check_normal(this_event, __func__)) {
+        struct event_waiter waiter;
+        ret = event_wait_any(&this_event, &waiter, 1, 0, NULL);
+        sys_value = waiter.value;
+    } else {
+        ret = -1;
+    }
+    put_event(this_event);
+    if (ret < 0) {
+        return ret;
     }
 
-    this_event->UIDFlag = UIDFlag;
-    this_event->GIDFlag = GIDFlag;
+    if (copy_to_user(value, &sys_value, sizeof(u64)) != 0) {
+        printk("error sys_doeventwaitval(): copy_to_user()\n");
+        return -1;
+    }
 
     return 0;
 }
@@ -511,63 +3413,168 @@ asmlinkage long sys_doeventchmod(int eventID, int UIDFlag, int GIDFlag)
 
 
 
+
 /*
- * Place the UID, GID, User Signal Enable Bit and Group Signal Enable Bit into the memory pointed to by UID, GID, UIDFlag and GIDFlag respectively.
+ * Bind the event with the given event ID to the aligned 32-bit word at uaddr, which waiters and signalers
+ * map shared, so uncontended signals and state checks need no syscall:
+ *  A signaler atomically ORs EVENT_WORD_SIGNALED into the word, and calls doeventsig only if the old value
+ *  had EVENT_WORD_WAITERS. A resetter clears EVENT_WORD_SIGNALED.
+ *  A waiter returns at once if the word has EVENT_WORD_SIGNALED, and calls doeventwait otherwise.
+ *  doeventwait sets EVENT_WORD_WAITERS after queueing and returns at once if EVENT_WORD_SIGNALED is set.
+ *  doeventsig clears EVENT_WORD_WAITERS as it wakes the waiters. doeventset, doeventreset and doeventpulse update
+ *  EVENT_WORD_SIGNALED too.
+ * The word is reset to 0, and its page stays pinned until the event is closed. An event can be bound once,
+ * before its ID is handed to waiters.
+ * The pinned page is charged to the caller's RLIMIT_MEMLOCK, as SHM_LOCK charges shared memory, until the event is freed.
  * Return 0 on success.
- * Return -1 on filure.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
  */
-asmlinkage long sys_doeventstat(int eventID, uid_t * UID, gid_t * GID, int * UIDFlag, int * GIDFlag)
+asmlinkage long sys_doeventbind(int eventID, u32 * uaddr)
 {
     /* Remember to check if event is initialized at kernel boot before actually doing anything. */
     if (event_initialized == false) {
-        printk("error sys_doeventstat(): event not initialized\n");
+        printk("error sys_doeventbind(): event not initialized\n");
         return -1;
     }
 
     /* Check arguments. */
-    if (UID == NULL || GID == NULL || UIDFlag == NULL || GIDFlag == NULL) {
-        printk("error sys_doeventstat(): invalid eventID\n");
+    unsigned long address = (unsigned long) uaddr;
+    if (uaddr == NULL || (address % sizeof(u32)) != 0) {
+        printk("error sys_doeventbind(): invalid arguments\n");
         return -1;
     }
 
-    unsigned long flags;  
-    /* Lock read. */
-    read_lock_irqsave(&eventID_list_lock, flags); 
-    /* Search for the event in event list. */
-    struct event * this_event = get_event(eventID); 
-    read_unlock_irqrestore(&eventID_list_lock, flags); 
-    /* Read unlocked. */
-
-    /* If event not found. */
+    /* Search for the event and check accessibility. */
+    struct event * this_event = get_event_access(eventID, __func__);
     if (this_event == NULL) {
-        printk("error sys_doeventstat(): event not found. eventID = %d\n", eventID);
+        return -1;
+    }
+    if (!event_check_normal(this_event, __func__)) {
+        put_event(this_event);
         return -1;
     }
 
-    
-
+    /* Charge the page to the caller's locked memory, so binding events cannot pin unbounded memory. */
+    struct event_word_pin * word_pin = kmalloc(sizeof(struct event_word_pin), GFP_KERNEL);
+    if (word_pin == NULL) {
+        put_event(this_event);
+        printk("error sys_doeventbind(): kmalloc()\n");
+        return -1;
+    }
+    word_pin->user = current_user();
+    if (!user_shm_lock(PAGE_SIZE, word_pin->user)) {
+        kfree(word_pin);
+        put_event(this_event);
+        printk("error sys_doeventbind(): RLIMIT_MEMLOCK exceeded\n");
+        return -1;
+    }
 
-    if (copy_to_user(UID, &(this_event->UID), sizeof(uid_t)) != 0) {
-        printk("error sys_doeventstat(): copy_to_user()\n");
+    /* Pin the page holding the word, so the kernel can reach it from any process and any context. */
+    down_read(&(current->mm->mmap_sem));
+    int pinned = get_user_pages(current, current->mm, address & PAGE_MASK, 1, 1, 0, &(word_pin->page), NULL);
+    up_read(&(current->mm->mmap_sem));
+    if (pinned != 1) {
+        user_shm_unlock(PAGE_SIZE, word_pin->user);
+        kfree(word_pin);
+        put_event(this_event);
+        printk("error sys_doeventbind(): get_user_pages()\n");
         return -1;
     }
+    atomic_t * word = (atomic_t *) ((char *) kmap(word_pin->page) + (address & ~PAGE_MASK));
 
-    if (copy_to_user(GID, &(this_event->GID), sizeof(gid_t)) != 0) {
-        printk("error sys_doeventstat(): copy_to_user()\n");
+    /* Publish the word under the wait queue lock, which signalers hold when they use it. */
+    unsigned long flags;
+    spin_lock_irqsave(&(this_event->wait_queue.lock), flags);
+    if (this_event->word != NULL) {
+        spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+        kunmap(word_pin->page);
+        put_page(word_pin->page);
+        user_shm_unlock(PAGE_SIZE, word_pin->user);
+        kfree(word_pin);
+        put_event(this_event);
+        printk("error sys_doeventbind(): event already bound. eventID = %d\n", eventID);
         return -1;
     }
+    /* Only an unbound event's word is reset, so a second bind cannot wipe a live word. */
+    atomic_set(word, 0);
+    this_event->word_pin = word_pin;
+    smp_wmb();
+    this_event->word = word;
+    spin_unlock_irqrestore(&(this_event->wait_queue.lock), flags);
+    put_event(this_event);
 
-    if (copy_to_user(UIDFlag, &(this_event->UIDFlag), sizeof(int)) != 0) {
-        printk("error sys_doeventstat(): copy_to_user()\n");
+    return 0;
+}
+
+
+
+
+
+
+/*
+ * Control the event with the given event ID.
+ * EVENT_CTL_GET_WAKE_AFFINITY: return the wake affinity policy. arg is ignored.
+ * EVENT_CTL_SET_WAKE_AFFINITY: set the wake affinity policy to arg, which signals of the event honor when they wake tasks:
+ *  EVENT_WAKE_DEFAULT wakes tasks as plain wake ups and leaves the CPU choice to the scheduler, whose wake_affine()
+ *  may still pull them to the signaler's CPU.
+ *  EVENT_WAKE_WAKER wakes tasks as sync wake ups, which pulls them towards the signaler's CPU harder, to share its hot data.
+ *  Keeping woken tasks on their own cache-hot CPU is not supported: no wake flag makes the scheduler skip wake_affine(),
+ *  and pinning the task would rewrite its affinity.
+ *  The policy applies to every kind of wait, and is read when the signal wakes the tasks.
+ *  Return 0.
+ * Return -1 on failure.
+ * Access denied:
+ *  EVENT_CTL_GET_WAKE_AFFINITY: uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ *  EVENT_CTL_SET_WAKE_AFFINITY: uid != 0 && uid != event->UID
+ */
+asmlinkage long sys_doeventctl(int eventID, int cmd, int arg)
+{
+    /* Remember to check if event is initialized at kernel boot before actually doing anything. */
+    if (event_initialized == false) {
+        printk("error sys_doeventctl(): event not initialized\n");
         return -1;
     }
 
-    if (copy_to_user(GIDFlag, &(this_event->GIDFlag), sizeof(int)) != 0) {
-        printk("error sys_doeventstat(): copy_to_user()\n");
+    /* Check arguments. */
+    if ((cmd != EVENT_CTL_GET_WAKE_AFFINITY && cmd != EVENT_CTL_SET_WAKE_AFFINITY)
+        || (cmd == EVENT_CTL_SET_WAKE_AFFINITY && arg != EVENT_WAKE_DEFAULT && arg != EVENT_WAKE_WAKER)) {
+        printk("error sys_doeventctl(): invalid arguments\n");
         return -1;
     }
 
+    /* Search for the event and check accessibility. Changing an attribute takes the owner, like chown and chmod. */
+    struct event * this_event;
+    if (cmd == EVENT_CTL_SET_WAKE_AFFINITY) {
+        this_event = get_event(eventID);
+        if (this_event == NULL) {
+            printk("error sys_doeventctl(): event not found. eventID = %d\n", eventID);
+            return -1;
+        }
+        uid_t uid = current->cred->euid;
+        if (uid != 0 && uid != this_event->UID) {
+            put_event(this_event);
+            printk("sys_doeventctl(): access denied\n");
+            return -1;
+        }
+    } else {
+        this_event = get_event_access(eventID, __func__);
+        if (this_event == NULL) {
+            return -1;
+        }
+    }
 
-    return 0;
-}
+    long ret = 0;
+    switch (cmd) {
+    case EVENT_CTL_GET_WAKE_AFFINITY:
+        ret = this_event->wake_affinity;
+        break;
+    case EVENT_CTL_SET_WAKE_AFFINITY:
+        ACCESS_ONCE(this_event->wake_affinity) = arg;
+        break;
+    }
+    put_event(this_event);
 
+    return ret;
+}
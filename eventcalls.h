@@ -35,20 +35,261 @@
 #include <linux/wait.h>
 #include <linux/spinlock.h>
 #include <linux/types.h>
+#include <linux/log2.h>
+#include <linux/sort.h>
+#include <linux/slab.h>
+#include <linux/rcupdate.h>
+#include <linux/rculist.h>
+#include <linux/bitops.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/highmem.h>
+#include <asm/atomic.h>
+
+/* Default and maximum number of event table buckets. Override with "eventbuckets=" at boot. */
+#define EVENT_TABLE_DEFAULT_BUCKETS 64
+#define EVENT_TABLE_MAX_BUCKETS     4096
 
+/*
+ * An event ID is made of three fields, from low to high bits:
+ *  bucket index (log2 of the bucket count), slot index within the bucket, generation.
+ * Bucket and slot index together take EVENT_ID_INDEX_BITS bits, the generation the rest.
+ * The generation is bumped each time a slot is recycled, so stale IDs do not match.
+ * Freed slots are reused first in, first out, behind at least EVENT_SLOT_REUSE_MIN other free slots of their bucket,
+ * so a stale ID can only match again after thousands of opens per generation step, not one.
+ */
+#define EVENT_ID_INDEX_BITS         20
+#define EVENT_ID_GENERATION_BITS    (31 - EVENT_ID_INDEX_BITS)
+#define EVENT_ID_GENERATION_MASK    ((1 << EVENT_ID_GENERATION_BITS) - 1)
+/* Slots of a bucket are allocated in chunks of this many. */
+#define EVENT_SLOT_CHUNK            64
+/* Number of free slots each CPU keeps for itself, and moves to or from the table at once. */
+#define EVENT_SLOT_BATCH            16
+/* A bucket grows rather than reuse a slot while it has fewer free slots than this, until it is full. */
+#define EVENT_SLOT_REUSE_MIN        (16 * EVENT_SLOT_CHUNK)
+
+/* Flags of doeventtimedwait, doeventwaitv and doeventwaitall. */
+#define EVENT_WAIT_ABSTIME      0x1 /* The timeout is an absolute CLOCK_MONOTONIC time. */
+#define EVENT_WAIT_EXCLUSIVE    0x2 /* Wait exclusively, as with doeventwaitexcl. */
+
+/* Flags of doeventflagwait. */
+#define EVENT_FLAG_ALL          0x1 /* Wait until all requested bits are set, instead of any of them. */
+#define EVENT_FLAG_CLEAR        0x2 /* Clear the requested bits on the way out. */
+
+/* Interest or fire mask matching everything, used by waits and signals that do not pass one. */
+#define EVENT_MASK_ALL          (~0U)
+
+/* Maximum number of events a single doeventwaitv or doeventwaitall call waits on. */
+#define EVENT_WAITV_MAX         64
+
+/* Event types, chosen at doeventcreate. doeventopen creates EVENT_TYPE_NORMAL events. */
+#define EVENT_TYPE_NORMAL       0   /* A signal wakes the current waiters and is not remembered. */
+#define EVENT_TYPE_SEMAPHORE    1   /* A signal adds a unit to a count, and each wait takes one. */
+#define EVENT_TYPE_AUTORESET    2   /* A signal sets the event until one wait takes it and resets it. */
+#define EVENT_TYPE_BARRIER      3   /* Waits block until a given number of participants have arrived. */
+#define EVENT_TYPE_MAILBOX      4   /* Signals enqueue 64-bit messages in a bounded ring, and waits dequeue them. */
+
+/* Commands of doeventctl. */
+#define EVENT_CTL_GET_WAKE_AFFINITY     1
+#define EVENT_CTL_SET_WAKE_AFFINITY     2
+
+/* Wake affinity policies of an event. */
+#define EVENT_WAKE_DEFAULT      0   /* Plain wake ups. The scheduler picks the CPU of a woken task. */
+#define EVENT_WAKE_WAKER        1   /* Sync wake ups, which pull woken tasks towards the signaler's CPU. */
+
+/* Bits of the user space word an event is bound to with doeventbind. */
+#define EVENT_WORD_SIGNALED     0x1 /* The event is set. */
+#define EVENT_WORD_WAITERS      0x2 /* A task may sleep on the event, so a signaler must call doeventsig. */
+
+/* Flag of doeventcreate for any type: waits spin before sleeping while the signaler runs. */
+#define EVENT_CREATE_ADAPTIVE           0x100
+/* Default and largest "eventspin=" boot time, in microseconds, of an adaptive wait. */
+#define EVENT_SPIN_DEFAULT_US           50
+#define EVENT_SPIN_MAX_US               10000
+
+/* Flags of doeventcreate for EVENT_TYPE_MAILBOX: what a send to a full queue does. */
+#define EVENT_MAILBOX_FULL_BLOCK        0x0 /* Wait for room. */
+#define EVENT_MAILBOX_FULL_FAIL         0x1 /* Fail with -EAGAIN. */
+#define EVENT_MAILBOX_FULL_OVERWRITE    0x2 /* Drop the oldest message. */
+#define EVENT_MAILBOX_FULL_MASK         0x3
+/* Largest capacity of a mailbox event. */
+#define EVENT_MAILBOX_MAX_CAPACITY      4096
+/* Interest masks of the receivers and blocked senders of a mailbox event. */
+#define EVENT_MAILBOX_RECEIVER          0x1
+#define EVENT_MAILBOX_SENDER            0x2
+
+/* Bits in event->status. */
+#define EVENT_CLOSED    0   /* Event has been removed from the table; waiters must not sleep on it. */
+#define EVENT_SIGNALED  1   /* Event is set: by doeventset until reset, or by a signal of an auto-reset event until a wait takes it. */
+#define EVENT_ADAPTIVE  2   /* Event was created with EVENT_CREATE_ADAPTIVE. */
+
+/*
+ * The fields are split in two cache lines.
+ * The first holds read-mostly data: the identity, the type parameters and the permission metadata,
+ * which only creation, chown, chmod, doeventctl and doeventbind write.
+ * The second holds everything waits and signals write: the reference count, the state bits and the wait queue.
+ * chown, chmod and stat look the event up under rcu_read_lock() and take no reference,
+ * so a chown on one CPU does not invalidate the line waiters and signalers on other CPUs are working on.
+ * On x86_64 each part fills exactly 64 bytes.
+ */
 struct event
 {
+    /* eventID should be positive integers. It encodes the event's table slot and its generation. */
+    int eventID;    
+    /* EVENT_TYPE_*. Fixed at creation. */
+    int type;
+    /* Number of participants of an EVENT_TYPE_BARRIER event. Fixed at creation. */
+    int participants;
+    /* EVENT_WAKE_* policy, set with doeventctl and read by every signal. */
+    int wake_affinity;
+    /* Message queue of an EVENT_TYPE_MAILBOX event, or NULL. */
+    struct event_mailbox * mailbox;
+    /* Pin of the user space word bound with doeventbind, or NULL. Set once. */
+    struct event_word_pin * word_pin;
+    /* Closed events are freed after an RCU grace period so lockless readers stay safe. */
+    struct rcu_head rcu;
+
+    /* Permission metadata. Read on every call, written only by chown and chmod. */
     uid_t UID;
     gid_t GID;
     int UIDFlag;
     int GIDFlag;
-    /* eventID should be positive integers. */
-    int eventID;    
-    /* Implement a kernel double-linked list fo events. */
-    struct list_head eventID_list;
+
+    /* One reference for the event table plus one per syscall using the event. */
+    atomic_t refcount ____cacheline_aligned_in_smp;
+    /* Signal sequence number. Bumped by every signal under wait_queue.lock, read locklessly. */
+    unsigned int seq;
+    /* EVENT_* state bits. */
+    unsigned long status;
     /* Implement a wait queue of processes waiting on the event. */
     wait_queue_head_t wait_queue;
+    /* Available units of an EVENT_TYPE_SEMAPHORE event, or arrived participants of an EVENT_TYPE_BARRIER event. */
+    atomic_t count;
+    /* Event flag bits set by doeventflagset. Written under wait_queue.lock. */
+    unsigned int flag_state;
+    /* Task that last signaled an adaptive event, or NULL. Written under wait_queue.lock. */
+    struct pid * signaler;
+    /* Kernel mapping of the user space word bound with doeventbind, or NULL. Set once. */
+    atomic_t * word;
+
+};
+
+
+/*
+ * Bounded message queue of a mailbox event. Guarded by the event's wait queue lock.
+ */
+struct event_mailbox
+{
+    /* Maximum number of queued messages, and EVENT_MAILBOX_FULL_* policy. Fixed at creation. */
+    unsigned int capacity;
+    int full_policy;
+    /* Index of the oldest message, and number of queued messages. */
+    unsigned int head;
+    unsigned int count;
+    u64 ring[0];
+};
+
+
+/*
+ * Pinned page of the user space word bound to an event, and the user whose RLIMIT_MEMLOCK it is charged to.
+ */
+struct event_word_pin
+{
+    struct page * page;
+    struct user_struct * user;
+};
+
+
+/*
+ * A task waiting on an event.
+ */
+struct event_waiter
+{
+    /* Entry in the event's wait queue. */
+    wait_queue_t wait;
+    /* Set by the wake function before the task is woken. */
+    int woken;
+    /* Interest mask. Only signals whose fire mask intersects it wake the waiter. */
+    unsigned int mask;
+    /* Value delivered by the signal that woke the waiter. */
+    u64 value;
+};
+
+
+/*
+ * Key a signal passes to the wake functions of the waiters.
+ */
+struct event_wake_key
+{
+    /* Fire mask. Waiters whose interest mask does not intersect it are skipped. */
+    unsigned int mask;
+    /* Value delivered to each woken waiter. */
+    u64 value;
+};
+
+
+/*
+ * A task waiting on event flag bits.
+ * Its wake function checks the condition under the wait queue lock, so only satisfied waiters are woken.
+ */
+struct event_flag_waiter
+{
+    struct event_waiter waiter;
+    /* Event waited on. */
+    struct event * event;
+    /* Requested bits, and EVENT_FLAG_* flags. */
+    unsigned int bits;
+    int flags;
+    /* Flag state that satisfied the wait, before any clearing. */
+    unsigned int state;
+};
+
+
+/*
+ * A slot of the event table.
+ */
+struct event_slot
+{
+    /* RCU-published event occupying the slot, or NULL when the slot is free. */
+    struct event * event;
+    /* Generation of the slot's current or next event. Never 0. */
+    unsigned int generation;
+    /* Index of the next free slot in the bucket, or -1. */
+    int next_free;
+};
+
 
+/*
+ * A bucket of the event table.
+ */
+struct event_bucket
+{
+    /* Guards the free list and growth. Opens and closes only take it to move batches of slots. */
+    spinlock_t lock;
+    /* Indexes of the first and last free slots, or -1. Slots are taken at the head and freed at the tail. */
+    int free_head;
+    int free_tail;
+    /* Number of free slots in the list. */
+    unsigned int nr_free;
+    /* Number of slots allocated so far. */
+    unsigned int nr_slots;
+    /* RCU-published chunks of EVENT_SLOT_CHUNK slots. Chunks are never freed. */
+    struct event_slot ** chunks;
+};
+
+
+/*
+ * Free slots reserved by one CPU.
+ */
+struct event_slot_cache
+{
+    /* Number of reserved slots. */
+    int nr;
+    /* Slot indexes, i.e. event IDs without their generation. */
+    unsigned int index[EVENT_SLOT_BATCH];
+    /* Slots freed on this CPU, which go back to the tails of their buckets, never straight to index. */
+    int nr_freed;
+    unsigned int freed[EVENT_SLOT_BATCH];
 };
 
 
@@ -56,16 +297,17 @@ struct event
 
 /*
  * Return the length of the list with given list_head.
- * Remember to call read_lock before.
+ * Remember to lock the list before.
  */
 int get_list_length(struct list_head * head);   
 
 
 
 /*
- * Return a pointer to the event with given event ID.
+ * Return a pointer to the event with given event ID and take a reference on it.
  * Return NULL if the event with the given event ID is not found.
- * Remember to call read_lock before.
+ * Lookup indexes the event's slot directly and takes no lock. Stale IDs are rejected by generation.
+ * Remember to call put_event() when done with the event.
  */
 struct event * get_event(int eventID);
 
@@ -73,7 +315,35 @@ struct event * get_event(int eventID);
 
 
 /*
- * Initialize a global event as the head of a linked list of other events.
+ * Drop a reference taken by get_event().
+ * The last reference frees the event after an RCU grace period.
+ */
+void put_event(struct event * this_event);
+
+
+
+
+/*
+ * Wake up tasks in the waiting queue of the given event.
+ * All non-exclusive waiters are woken, and up to nr exclusive waiters, or all of them if nr is 0.
+ * Return the number of processes actually woken.
+ */
+int event_signal_nr(struct event * this_event, int nr);
+
+
+
+
+/*
+ * Wake up all tasks in the waiting queue of the given event.
+ * Return the number of processes signaled.
+ */
+int event_signal(struct event * this_event);
+
+
+
+
+/*
+ * Allocate the event table with the bucket count given at boot, rounded up to a power of two.
  * This function should be called in function start_kernel() in linux/init/main.c at kernel boot.
  */
 void doevent_init();
@@ -83,7 +353,7 @@ void doevent_init();
 
 /* 181
  * Create a new event and assign an event ID to it.
- * Add the new event to the global event list.
+ * Add the new event to the event table.
  * Return event id on success.
  * Return -1 on failure.
  */
@@ -94,7 +364,7 @@ asmlinkage long sys_doeventopen();
 
 /* 182
  * Wake up all tasks in the waiting queue of the event with given eventID.
- * Remove the event from global event list.
+ * Remove the event from the event table.
  * Free memory which hold the event.
  * Return the number of processed signaled on success.
  * Return -1 on failure.
@@ -121,7 +391,9 @@ asmlinkage long sys_doeventwait(int eventID);
 /* 184
  * Wake up all tasks waiting in the event with the given event ID.
  * Remove all tasks from waiting queue.
- * Return the number of processes signaled on success.
+ * Return the number of processes actually woken on success.
+ * Return -EOVERFLOW if a semaphore event would hold more than INT_MAX units, see doeventcreate.
+ * Return -EAGAIN if a mailbox event is full, or -EPIPE if it was closed, see doeventcreate.
  * Return -1 on failure.
  * Access denied:
  *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
@@ -132,7 +404,7 @@ asmlinkage long sys_doeventsig(int eventID);
 
 
 /* 185
- * If eventIDs != NULL && num >= event_count, copy all event IDs to user array pointed to by eventIDs.
+ * If eventIDs != NULL && num >= event_count, copy all event IDs in ascending order to user array pointed to by eventIDs.
  * If eventIDs == NULL || num < event_count, do not copy.
  * Return the number of active events on success.
  * Return -1 on failure.
@@ -174,8 +446,347 @@ asmlinkage long sys_doeventchmod(int eventID, int UIDFlag, int GIDFlag);
 asmlinkage long sys_doeventstat(int eventID, uid_t * UID, gid_t * GID, int * UIDFlag, int * GIDFlag);
 
 
-extern rwlock_t eventID_list_lock;  //provide read write lock to evnetID list
-extern struct event global_event;   //provide the main list
+
+
+/* 299
+ * Make the calling task wait exclusively in the wait queue of the event with the given eventID.
+ * Exclusive waiters are released one at a time by doeventsigone, and all at once by doeventsig and doeventclose.
+ * Return 0 on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitexcl(int eventID);
+
+
+
+
+/* 300
+ * Wake up one exclusive waiter of the event with the given event ID, along with any non-exclusive waiters.
+ * Return the number of processes actually woken on success.
+ * Return -EOVERFLOW if a semaphore event would hold more than INT_MAX units, see doeventcreate.
+ * Return -EAGAIN if a mailbox event is full, or -EPIPE if it was closed, see doeventcreate.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventsigone(int eventID);
+
+
+
+
+/* 301
+ * Wake up to nr exclusive waiters of the event with the given event ID, along with any non-exclusive waiters.
+ * Return the number of processes actually woken on success.
+ * Return -EOVERFLOW if a semaphore event would hold more than INT_MAX units, see doeventcreate.
+ * Return -EAGAIN if a mailbox event is full, or -EPIPE if it was closed, see doeventcreate.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventsign(int eventID, int nr);
+
+
+
+
+/* 302
+ * Make the calling task wait in the wait queue of the event with the given eventID, for at most the given time.
+ * timeout is relative, or an absolute CLOCK_MONOTONIC time if flags has EVENT_WAIT_ABSTIME.
+ * With EVENT_WAIT_EXCLUSIVE the caller waits exclusively, as with doeventwaitexcl.
+ * Return 0 if signaled.
+ * Return -ETIMEDOUT if the timeout expired first.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventtimedwait(int eventID, struct timespec * timeout, int flags);
+
+
+
+
+/* 303
+ * Make the calling task wait on all num events with the IDs in the user array eventIDs, until any of them is signaled or closed.
+ * If timeout is not NULL, wait for at most that time, which is relative or, with EVENT_WAIT_ABSTIME in flags, an absolute CLOCK_MONOTONIC time.
+ * num must be between 1 and EVENT_WAITV_MAX.
+ * Return the index in eventIDs of the event that fired. If several fired, the lowest index.
+ * Return -ETIMEDOUT if the timeout expired first.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied on any of the events:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitv(int num, int * eventIDs, struct timespec * timeout, int flags);
+
+
+
+
+/* 304
+ * Make the calling task wait on all num events with the IDs in the user array eventIDs, until every one of them has been signaled or closed since the call began.
+ * If timeout is not NULL, wait for at most that time, which is relative or, with EVENT_WAIT_ABSTIME in flags, an absolute CLOCK_MONOTONIC time.
+ * num must be between 1 and EVENT_WAITV_MAX.
+ * If fired is not NULL, fill the user array fired, of num ints, with 1 for each event that fired and 0 for the others, also on timeout or interruption.
+ * Return 0 if all events fired.
+ * Return -ETIMEDOUT if the timeout expired first.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied on any of the events:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitall(int num, int * eventIDs, int * fired, struct timespec * timeout, int flags);
+
+
+
+
+/* 305
+ * Set the event with the given event ID, and wake up all tasks waiting in it.
+ * The event stays set until doeventreset, and waits on it return immediately in the meantime.
+ * Return the number of processes actually woken on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventset(int eventID);
+
+
+
+
+/* 306
+ * Reset the event with the given event ID, so waits on it block again.
+ * Return 0 on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventreset(int eventID);
+
+
+
+
+/* 307
+ * Wake up all tasks waiting in the event with the given event ID, and leave the event reset.
+ * Unlike doeventsig, this also clears a set made by doeventset.
+ * Return the number of processes actually woken on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventpulse(int eventID);
+
+
+
+
+/* 308
+ * Return the signal sequence number of the event with the given event ID on success.
+ * Every signal of the event, including a close, increments it.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventseq(int eventID);
+
+
+
+
+/* 309
+ * Make the calling task wait in the event with the given event ID, if its signal sequence number still equals seq.
+ * The compare and the queueing are atomic with respect to signals, so a signal after reading seq is never missed.
+ * Return 0 if signaled, set or closed.
+ * Return -EAGAIN if the sequence number differs from seq.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitseq(int eventID, unsigned int seq);
+
+
+
+
+/* 310
+ * Create a new event of the given type and assign an event ID to it, like doeventopen.
+ * EVENT_TYPE_NORMAL: arg must be 0.
+ * EVENT_TYPE_SEMAPHORE: arg is the initial number of units, at least 0.
+ *  doeventsig and doeventsigone add one unit and doeventsign adds nr, waking as many waiters.
+ *  doeventwait, doeventwaitexcl and doeventtimedwait take one unit, and block while there is none.
+ *  Units accumulate while nobody waits, up to INT_MAX. A signal that would go past it adds nothing and fails with -EOVERFLOW.
+ * EVENT_TYPE_AUTORESET: arg is 1 to create the event set, or 0.
+ *  doeventsig, doeventsigone and doeventsign set the event, and wake one waiter.
+ *  doeventwait, doeventwaitexcl and doeventtimedwait block until the event is set, and reset it on the way out,
+ *  so each set lets exactly one waiter through. doeventreset resets the event.
+ * EVENT_TYPE_BARRIER: arg is the number of participants, at least 1.
+ *  doeventwait, doeventwaitexcl and doeventtimedwait arrive at the barrier, and block until the last participant
+ *  arrives, which releases them all at once and re-arms the barrier for the next phase.
+ *  doeventsig, doeventsigone and doeventsign release the waiting participants early.
+ *  A participant that times out or is interrupted before the release no longer counts as arrived.
+ * EVENT_TYPE_MAILBOX: arg is the capacity of the message queue, from 1 to EVENT_MAILBOX_MAX_CAPACITY.
+ *  doeventsigval enqueues a 64-bit message and wakes one receiver, and doeventwaitval dequeues one, blocking while
+ *  there is none. doeventsig and doeventsigone enqueue a 0 message, doeventsign enqueues nr of them, up to the capacity,
+ *  and the other waits discard one. These plain signals never wait for room: on a full queue they fail with -EAGAIN,
+ *  unless the policy is EVENT_MAILBOX_FULL_OVERWRITE. doeventsign stops at the first message it cannot enqueue,
+ *  and fails only if it enqueued none.
+ *  flags picks what a doeventsigval to a full queue does: EVENT_MAILBOX_FULL_BLOCK waits for room,
+ *  EVENT_MAILBOX_FULL_FAIL returns -EAGAIN and EVENT_MAILBOX_FULL_OVERWRITE drops the oldest message.
+ *  Once closed, receivers drain the queued messages, then get -EPIPE, as do senders.
+ * flags must be 0 for other types, apart from EVENT_CREATE_ADAPTIVE, which any type takes.
+ * With EVENT_CREATE_ADAPTIVE, non-exclusive doeventwait and doeventtimedwait calls on an EVENT_TYPE_NORMAL event
+ * spin for up to the "eventspin=" boot time, never past their timeout, before sleeping, while the last task to signal the event runs on a CPU.
+ * Return event id on success.
+ * Return -1 on failure.
+ */
+asmlinkage long sys_doeventcreate(int type, int arg, int flags);
+
+
+
+
+/* 311
+ * Make the calling task wait in the event with the given event ID until it is signaled with a fire mask that
+ * intersects the given interest mask, or set or closed. doeventsig and other unmasked signals fire all bits.
+ * mask must not be 0.
+ * Return 0 if signaled, set or closed.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitmask(int eventID, unsigned int mask);
+
+
+
+
+/* 312
+ * Wake up the tasks waiting in the event with the given event ID whose interest mask intersects the given fire mask.
+ * Waiters that did not pass an interest mask match any fire mask.
+ * mask must not be 0.
+ * Return the number of processes actually woken on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventsigmask(int eventID, unsigned int mask);
+
+
+
+
+/* 313
+ * Set the given flag bits of the event with the given event ID, and wake up the doeventflagwait waiters whose condition now holds.
+ * Other waiters are not woken, and the signal sequence number is unchanged.
+ * bits must not be 0.
+ * Return the number of processes actually woken on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventflagset(int eventID, unsigned int bits);
+
+
+
+
+/* 314
+ * Clear the given flag bits of the event with the given event ID.
+ * Return the flag bits from before the clear on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventflagclear(int eventID, unsigned int bits);
+
+
+
+
+/* 315
+ * Make the calling task wait until any of the given flag bits of the event with the given event ID are set,
+ * or all of them if flags has EVENT_FLAG_ALL. Return at once if they already are.
+ * With EVENT_FLAG_CLEAR in flags, the requested bits are cleared as the wait is satisfied.
+ * bits must not be 0.
+ * Return the flag bits that satisfied the wait, from before any clearing, on success.
+ * Return 0 if the event was closed.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventflagwait(int eventID, unsigned int bits, int flags);
+
+
+
+
+/* 316
+ * Wake up all tasks waiting in the event with the given event ID, and deliver the given value to each of them.
+ * For a mailbox event, enqueue the value as a message for one receiver instead, see doeventcreate.
+ * Return the number of processes actually woken on success.
+ * Return -EAGAIN if a mailbox event is full and its policy is EVENT_MAILBOX_FULL_FAIL.
+ * Return -EPIPE if a mailbox event was closed.
+ * Return -EINTR if interrupted by a signal while waiting for room in a mailbox event.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventsigval(int eventID, u64 value);
+
+
+
+
+/* 317
+ * Make the calling task wait in the event with the given event ID, and store in value the value of the signal that woke it.
+ * The value is 0 if the task was woken by a signal without a value, by a set or by a close.
+ * For a mailbox event, dequeue the oldest message into value instead, waiting while there is none.
+ * Return 0 if signaled, set or closed, or a message was received.
+ * Return -EPIPE if a mailbox event was closed and has no messages left.
+ * Return -EINTR if interrupted by a signal first.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventwaitval(int eventID, u64 * value);
+
+
+
+
+/* 318
+ * Bind the event with the given event ID to the aligned 32-bit word at uaddr, which waiters and signalers
+ * map shared, so uncontended signals and state checks need no syscall:
+ *  A signaler atomically ORs EVENT_WORD_SIGNALED into the word, and calls doeventsig only if the old value
+ *  had EVENT_WORD_WAITERS. A resetter clears EVENT_WORD_SIGNALED.
+ *  A waiter returns at once if the word has EVENT_WORD_SIGNALED, and calls doeventwait otherwise.
+ *  doeventwait sets EVENT_WORD_WAITERS after queueing and returns at once if EVENT_WORD_SIGNALED is set.
+ *  doeventsig clears EVENT_WORD_WAITERS as it wakes the waiters. doeventset, doeventreset and doeventpulse update
+ *  EVENT_WORD_SIGNALED too.
+ * The word is reset to 0, and its page stays pinned until the event is closed. An event can be bound once,
+ * before its ID is handed to waiters.
+ * The pinned page is charged to the caller's RLIMIT_MEMLOCK, as SHM_LOCK charges shared memory, until the event is freed.
+ * Return 0 on success.
+ * Return -1 on failure.
+ * Access denied:
+ *  uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ */
+asmlinkage long sys_doeventbind(int eventID, u32 * uaddr);
+
+
+
+
+/* 319
+ * Control the event with the given event ID.
+ * EVENT_CTL_GET_WAKE_AFFINITY: return the wake affinity policy. arg is ignored.
+ * EVENT_CTL_SET_WAKE_AFFINITY: set the wake affinity policy to arg, which signals of the event honor when they wake tasks:
+ *  EVENT_WAKE_DEFAULT wakes tasks as plain wake ups and leaves the CPU choice to the scheduler, whose wake_affine()
+ *  may still pull them to the signaler's CPU.
+ *  EVENT_WAKE_WAKER wakes tasks as sync wake ups, which pulls them towards the signaler's CPU harder, to share its hot data.
+ *  Keeping woken tasks on their own cache-hot CPU is not supported: no wake flag makes the scheduler skip wake_affine(),
+ *  and pinning the task would rewrite its affinity.
+ *  The policy applies to every kind of wait, and is read when the signal wakes the tasks.
+ *  Return 0.
+ * Return -1 on failure.
+ * Access denied:
+ *  EVENT_CTL_GET_WAKE_AFFINITY: uid != 0 && (uid != event->UID || event->UIDFlag == 0) && (gid != event->GID || event->GIDFlag == 0)
+ *  EVENT_CTL_SET_WAKE_AFFINITY: uid != 0 && uid != event->UID
+ */
+asmlinkage long sys_doeventctl(int eventID, int cmd, int arg);
+
+
+extern struct event_bucket * event_table;   //provide the event table
+extern unsigned int event_table_mask;   //number of buckets minus one
+extern unsigned int event_table_shift;  //log2 of the number of buckets
 extern bool event_initialized;  //indicate if the global event has been initialized
 
 #endif
@@ -0,0 +1,106 @@
+#define _GNU_SOURCE
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+
+/*
+ * Count how often a woken task changes CPU under each wake affinity policy of doeventctl.
+ * A signaler pinned to CPU 0 wakes an unpinned waiter, which checks its CPU before and after each wait.
+ * EVENT_WAKE_WAKER asks for sync wake ups, which should move the waiter next to the signaler more often.
+ * Under EVENT_WAKE_DEFAULT the scheduler's wake_affine() may pull the waiter there as well, so compare the counts
+ * rather than expect the waiter to stay on its previous CPU.
+ * Usage: bench_affinity <wake ups>
+ */
+
+struct result {
+	long migrations;
+	long on_signaler_cpu;
+};
+
+static void pin(int cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	sched_setaffinity(0, sizeof(set), &set);
+}
+
+/* Wake the waiter the given number of times under the given policy. */
+static void run(int policy, int rounds, struct result *res)
+{
+	int ping, pong, i;
+
+	/* creat events */
+	ping = syscall(181);
+	pong = syscall(181);
+	/* doeventctl(ping, EVENT_CTL_SET_WAKE_AFFINITY, policy) */
+	if (syscall(319, ping, 2, policy) == -1) {
+		printf("doeventctl fail\n");
+		exit(1);
+	}
+	res->migrations = 0;
+	res->on_signaler_cpu = 0;
+
+	if (fork() == 0) {
+		cpu_set_t all;
+		CPU_ZERO(&all);
+		for (i = 0; i < CPU_SETSIZE; i++)
+			CPU_SET(i, &all);
+		sched_setaffinity(0, sizeof(all), &all);
+		for (i = 0; i < rounds; i++) {
+			int before = sched_getcpu();
+			syscall(183, ping);	/* doeventwait */
+			syscall(306, ping);	/* doeventreset */
+			int after = sched_getcpu();
+			if (after != before)
+				res->migrations++;
+			if (after == 0)
+				res->on_signaler_cpu++;
+			syscall(305, pong);	/* doeventset */
+		}
+		exit(0);
+	}
+
+	pin(0);
+	for (i = 0; i < rounds; i++) {
+		/* let the waiter go to sleep first */
+		usleep(100);
+		syscall(305, ping);	/* doeventset */
+		syscall(183, pong);	/* doeventwait */
+		syscall(306, pong);	/* doeventreset */
+	}
+	wait(NULL);
+
+	/* doeventclose */
+	syscall(182, ping);
+	syscall(182, pong);
+}
+
+int main(int argc, char **argv)
+{
+	static const char *names[] = { "default", "waker" };
+	if (argc != 2) { /* input arguments count wrong */
+		printf("input error\n");
+		return 0;
+	}
+	int rounds = atoi(argv[1]);
+	if (rounds < 1) {
+		printf("input error\n");
+		return 0;
+	}
+
+	/* the waiter fills in its counts in shared memory */
+	struct result *res = mmap(NULL, sizeof(struct result), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	int policy;
+	for (policy = 0; policy < 2; policy++) {
+		run(policy, rounds, res);
+		printf("%-8s migrations: %ld/%d, woken on signaler's CPU: %ld/%d\n",
+		       names[policy], res->migrations, rounds, res->on_signaler_cpu, rounds);
+	}
+	return 0;
+}
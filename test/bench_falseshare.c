@@ -0,0 +1,148 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+
+/*
+ * Compare the old and the new layout of struct event under doeventchown, with user space copies of both.
+ * Signaler threads replay what doeventsig does to the event: take a reference, check the permission
+ * metadata, take and drop the wait queue lock, and drop the reference. One thread replays doeventchown,
+ * which writes UID and GID and, since it runs under rcu_read_lock(), no longer takes a reference.
+ * In the old layout UID and GID share the line the signalers write, so every chown steals it from them.
+ * In the new layout chown only invalidates the read-mostly first line, which the signalers just read.
+ * Usage: bench_falseshare <signaler threads> <seconds>
+ */
+
+/* Old layout: the permission metadata sits next to the reference count and the wait queue lock. */
+struct event_old
+{
+	int refcount;
+	int lock;
+	unsigned int UID;
+	unsigned int GID;
+} __attribute__((aligned(64)));
+
+/* New layout: the permission metadata on the first line, what signals write on the second. */
+struct event_new
+{
+	unsigned int UID;
+	unsigned int GID;
+	int refcount __attribute__((aligned(64)));
+	int lock;
+} __attribute__((aligned(64)));
+
+static struct event_old old_event;
+static struct event_new new_event;
+static int use_new;
+static volatile int stop;
+static long counts[64];
+
+static void pin(int cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	sched_setaffinity(0, sizeof(set), &set);
+}
+
+/* What doeventsig does to the fields of the event when no one waits. */
+#define SIGNAL(ev, uid) do { \
+	__sync_fetch_and_add(&(ev)->refcount, 1); \
+	if ((ev)->UID == (uid) || (ev)->GID == (uid)) { \
+		while (__sync_lock_test_and_set(&(ev)->lock, 1)) \
+			; \
+		__sync_lock_release(&(ev)->lock); \
+	} \
+	__sync_fetch_and_sub(&(ev)->refcount, 1); \
+} while (0)
+
+/* Signal the event as fast as possible. */
+static void *signaler(void *arg)
+{
+	long i = (long) arg;
+	unsigned int uid = geteuid();
+	pin(i + 1);
+	while (!stop) {
+		if (use_new)
+			SIGNAL(&new_event, uid);
+		else
+			SIGNAL(&old_event, uid);
+		counts[i]++;
+	}
+	return NULL;
+}
+
+/* Rewrite the event's UID and GID with their current values, as doeventchown does. */
+static void *chowner(void *arg)
+{
+	unsigned int uid = geteuid();
+	pin(0);
+	while (!stop) {
+		if (use_new) {
+			*(volatile unsigned int *) &new_event.UID = uid;
+			*(volatile unsigned int *) &new_event.GID = uid;
+		} else {
+			*(volatile unsigned int *) &old_event.UID = uid;
+			*(volatile unsigned int *) &old_event.GID = uid;
+		}
+	}
+	return NULL;
+}
+
+/* Run the signalers and the chowner for the given time and return the signalers' total rate in calls per second. */
+static double run(int threads, int seconds)
+{
+	pthread_t tid[64], chown_tid;
+	struct timespec start, end;
+	long total = 0;
+	int i;
+
+	stop = 0;
+	for (i = 0; i < threads; i++)
+		counts[i] = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_create(&chown_tid, NULL, chowner, NULL);
+	for (i = 0; i < threads; i++)
+		pthread_create(&tid[i], NULL, signaler, (void *) (long) i);
+	sleep(seconds);
+	stop = 1;
+	for (i = 0; i < threads; i++) {
+		pthread_join(tid[i], NULL);
+		total += counts[i];
+	}
+	pthread_join(chown_tid, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return total / ((end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3) { /* input arguments count wrong */
+		printf("input error\n");
+		return 0;
+	}
+	int threads = atoi(argv[1]);
+	int seconds = atoi(argv[2]);
+	if (threads < 1 || threads > 63) {
+		printf("input error\n");
+		return 0;
+	}
+
+	old_event.UID = old_event.GID = new_event.UID = new_event.GID = geteuid();
+
+	use_new = 0;
+	double old_rate = run(threads, seconds);
+	use_new = 1;
+	double new_rate = run(threads, seconds);
+
+	printf("signals/s under chown, old layout: %.0f\n", old_rate);
+	printf("signals/s under chown, new layout: %.0f\n", new_rate);
+	printf("speedup: %.1f%%\n", 100.0 * (new_rate - old_rate) / old_rate);
+
+	return 0;
+}
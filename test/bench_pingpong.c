@@ -0,0 +1,85 @@
+#define _GNU_SOURCE
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+
+/*
+ * Measure the request/response round trip between two processes on different CPUs,
+ * with plain events and with adaptive events that spin while the peer runs.
+ * Each side sets the peer's event, then waits on its own and resets it.
+ * Usage: bench_pingpong <round trips>
+ */
+
+static void pin(int cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	sched_setaffinity(0, sizeof(set), &set);
+}
+
+/* Bounce between the two events the given number of times and return the mean round trip in microseconds. */
+static double run(int flags, int rounds)
+{
+	struct timespec start, end;
+	int ping, pong, i;
+
+	/* doeventcreate(EVENT_TYPE_NORMAL, 0, flags) */
+	ping = syscall(310, 0, 0, flags);
+	pong = syscall(310, 0, 0, flags);
+	if (ping == -1 || pong == -1) {
+		printf("doeventcreate fail\n");
+		exit(1);
+	}
+
+	if (fork() == 0) {
+		pin(1);
+		for (i = 0; i < rounds; i++) {
+			syscall(183, ping);	/* doeventwait */
+			syscall(306, ping);	/* doeventreset */
+			syscall(305, pong);	/* doeventset */
+		}
+		exit(0);
+	}
+
+	pin(0);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < rounds; i++) {
+		syscall(305, ping);	/* doeventset */
+		syscall(183, pong);	/* doeventwait */
+		syscall(306, pong);	/* doeventreset */
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	wait(NULL);
+
+	/* doeventclose */
+	syscall(182, ping);
+	syscall(182, pong);
+
+	return ((end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3) / rounds;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 2) { /* input arguments count wrong */
+		printf("input error\n");
+		return 0;
+	}
+	int rounds = atoi(argv[1]);
+	if (rounds < 1) {
+		printf("input error\n");
+		return 0;
+	}
+
+	double sleeping = run(0, rounds);
+	double adaptive = run(0x100, rounds);	/* EVENT_CREATE_ADAPTIVE */
+
+	printf("round trip, sleeping waits: %.2f us\n", sleeping);
+	printf("round trip, adaptive waits: %.2f us\n", adaptive);
+	return 0;
+}
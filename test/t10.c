@@ -0,0 +1,44 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+/* Park several children exclusively on one event, then release them one signal at a time */
+int main(int argc, char **argv){
+	if(argc != 2){
+		printf("Input error\n");
+		return 0;
+	}
+	int children = atoi(argv[1]);
+	int eid, i, sig;
+
+	/* creat event */
+	eid = syscall(181);
+	printf("the event ID is %d\n", eid);
+
+	for(i = 0; i < children; i++){
+		if(fork() == 0){
+			/* doeventwaitexcl */
+			if(syscall(299, eid) == -1){
+				printf("Fail in waiting\n");
+				exit(1);
+			}
+			printf("child %d woken\n", getpid());
+			exit(0);
+		}
+	}
+	sleep(1);
+
+	/* doeventsigone: each signal should wake exactly one child */
+	for(i = 0; i < children; i++){
+		sig = syscall(300, eid);
+		printf("doeventsigone signaled %d\n", sig);
+		sleep(1);
+	}
+
+	while(wait(NULL) > 0);
+	/* doeventclose */
+	syscall(182, eid);
+	return 0;
+}
@@ -0,0 +1,42 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+/* Park several children exclusively on one event, then wake a given number of them with one call */
+int main(int argc, char **argv){
+	if(argc != 3){
+		printf("Input error\n");
+		return 0;
+	}
+	int children = atoi(argv[1]);
+	int nr = atoi(argv[2]);
+	int eid, i, sig;
+
+	/* creat event */
+	eid = syscall(181);
+	printf("the event ID is %d\n", eid);
+
+	for(i = 0; i < children; i++){
+		if(fork() == 0){
+			/* doeventwaitexcl */
+			syscall(299, eid);
+			printf("child %d woken\n", getpid());
+			exit(0);
+		}
+	}
+	sleep(1);
+
+	/* doeventsign: should report min(nr, children) woken */
+	sig = syscall(301, eid, nr);
+	printf("doeventsign woke %d of %d\n", sig, children);
+	sleep(1);
+
+	/* doeventclose releases the rest */
+	sig = syscall(182, eid);
+	printf("doeventclose woke %d\n", sig);
+
+	while(wait(NULL) > 0);
+	return 0;
+}
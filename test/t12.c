@@ -0,0 +1,48 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+/* Wait on an event with given eventID for at most the given number of milliseconds */
+int main(int argc, char **argv){
+	if(argc != 3 && argc != 4){
+		printf("Input error\n");
+		return 0;
+	}
+	int eid = atoi(argv[1]);
+	long ms = atol(argv[2]);
+	/* any third argument makes the deadline absolute */
+	int flags = (argc == 4) ? 1 : 0;
+	struct timespec ts, start, end;
+	long ret;
+
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (ms % 1000) * 1000000;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if(flags){
+		ts.tv_sec += start.tv_sec;
+		ts.tv_nsec += start.tv_nsec;
+		if(ts.tv_nsec >= 1000000000){
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+	}
+
+	/* doeventtimedwait */
+	ret = syscall(302, eid, &ts, flags);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if(ret == 0)
+		printf("signaled");
+	else if(errno == ETIMEDOUT)
+		printf("timed out");
+	else if(errno == EINTR)
+		printf("interrupted");
+	else
+		printf("Fail in waiting: %s", strerror(errno));
+	printf(" after %ld ms\n", (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000);
+	return 0;
+}
@@ -0,0 +1,40 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+/* Wait on any of the events with given eventIDs, for at most the given number of milliseconds if it is not negative */
+int main(int argc, char **argv){
+	if(argc < 3){
+		printf("Input error\n");
+		return 0;
+	}
+	long ms = atol(argv[1]);
+	int num = argc - 2;
+	int *eids = malloc(num * sizeof(int));
+	int i;
+	struct timespec ts;
+	long ret;
+
+	for(i = 0; i < num; i++)
+		eids[i] = atoi(argv[i + 2]);
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (ms % 1000) * 1000000;
+
+	/* doeventwaitv */
+	ret = syscall(303, num, eids, (ms < 0) ? NULL : &ts, 0);
+
+	if(ret >= 0)
+		printf("event %d fired\n", eids[ret]);
+	else if(errno == ETIMEDOUT)
+		printf("timed out\n");
+	else if(errno == EINTR)
+		printf("interrupted\n");
+	else
+		printf("Fail in waiting: %s\n", strerror(errno));
+	free(eids);
+	return 0;
+}
@@ -0,0 +1,47 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+/* Wait until all of the events with given eventIDs fire, for at most the given number of milliseconds if it is not negative */
+int main(int argc, char **argv){
+	if(argc < 3){
+		printf("Input error\n");
+		return 0;
+	}
+	long ms = atol(argv[1]);
+	int num = argc - 2;
+	int *eids = malloc(num * sizeof(int));
+	int *fired = malloc(num * sizeof(int));
+	int i;
+	struct timespec ts;
+	long ret;
+
+	for(i = 0; i < num; i++)
+		eids[i] = atoi(argv[i + 2]);
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (ms % 1000) * 1000000;
+
+	/* doeventwaitall */
+	ret = syscall(304, num, eids, fired, (ms < 0) ? NULL : &ts, 0);
+
+	if(ret == 0)
+		printf("all fired\n");
+	else if(errno == ETIMEDOUT)
+		printf("timed out\n");
+	else if(errno == EINTR)
+		printf("interrupted\n");
+	else{
+		printf("Fail in waiting: %s\n", strerror(errno));
+		goto out;
+	}
+	for(i = 0; i < num; i++)
+		printf("event %d: %s\n", eids[i], fired[i] ? "fired" : "not fired");
+out:
+	free(eids);
+	free(fired);
+	return 0;
+}
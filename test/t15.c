@@ -0,0 +1,45 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+/* Set an event before anyone waits, check the wait does not block, then reset and pulse it */
+int main(int argc, char **argv){
+	int eid;
+	long ret;
+
+	/* creat event */
+	eid = syscall(181);
+	printf("the event ID is %d\n", eid);
+
+	/* doeventset: no waiter yet, the signal is kept */
+	ret = syscall(305, eid);
+	printf("set woke %ld processes\n", ret);
+
+	/* doeventwait returns at once on a set event */
+	if(syscall(183, eid) == -1)
+		printf("Fail in waiting\n");
+	else
+		printf("wait on set event returned\n");
+
+	/* doeventreset */
+	syscall(306, eid);
+
+	if(fork() == 0){
+		/* doeventwait: blocks until the pulse */
+		syscall(183, eid);
+		printf("child woken by pulse\n");
+		exit(0);
+	}
+	sleep(1);
+
+	/* doeventpulse: wakes the child and leaves the event reset */
+	ret = syscall(307, eid);
+	printf("pulse woke %ld processes\n", ret);
+	wait(NULL);
+
+	/* doeventclose */
+	syscall(182, eid);
+	return 0;
+}
@@ -0,0 +1,34 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+/* Read the sequence number of an event with given eventID, then wait only if it has not changed */
+int main(int argc, char **argv){
+	if(argc != 2){
+		printf("Input error\n");
+		return 0;
+	}
+	int eid = atoi(argv[1]);
+	long seq, ret;
+
+	/* doeventseq */
+	seq = syscall(308, eid);
+	if(seq == -1){
+		printf("Fail in reading sequence\n");
+		return 0;
+	}
+	printf("sequence is %ld, waiting\n", seq);
+
+	/* doeventwaitseq */
+	ret = syscall(309, eid, (unsigned int)seq);
+	if(ret == 0)
+		printf("signaled\n");
+	else if(errno == EAGAIN)
+		printf("signaled before the wait, sequence now %ld\n", syscall(308, eid));
+	else
+		printf("Fail in waiting: %s\n", strerror(errno));
+	return 0;
+}
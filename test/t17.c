@@ -0,0 +1,54 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+/* Create a semaphore event with given initial units, run given number of workers that each take one unit, then post units for the rest, and check that the count cannot overflow */
+int main(int argc, char **argv){
+	if(argc != 3){
+		printf("Input error\n");
+		return 0;
+	}
+	int units = atoi(argv[1]);
+	int workers = atoi(argv[2]);
+	int eid, i;
+
+	/* doeventcreate(EVENT_TYPE_SEMAPHORE, units, 0) */
+	eid = syscall(310, 1, units, 0);
+	if(eid == -1){
+		printf("Fail in creating\n");
+		return 0;
+	}
+	printf("the event ID is %d\n", eid);
+
+	for(i = 0; i < workers; i++){
+		if(fork() == 0){
+			/* doeventwait: takes one unit */
+			syscall(183, eid);
+			printf("worker %d got a unit\n", getpid());
+			exit(0);
+		}
+	}
+	sleep(1);
+
+	/* doeventsign: post the units still missing */
+	if(workers > units)
+		printf("posting %d units woke %ld workers\n", workers - units, syscall(301, eid, workers - units));
+	for(i = 0; i < workers; i++)
+		wait(NULL);
+
+	/* doeventsign: fill the count up to INT_MAX, then one more unit must be refused */
+	long have = (units > workers) ? units - workers : 0;
+	syscall(301, eid, INT_MAX - have);
+	if(syscall(300, eid) == -1 && errno == EOVERFLOW)
+		printf("overflow refused\n");
+	else
+		printf("Fail in refusing overflow\n");
+
+	/* doeventclose */
+	syscall(182, eid);
+	return 0;
+}
@@ -0,0 +1,48 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+/* Park given number of workers on an auto-reset event and let them through one signal at a time */
+int main(int argc, char **argv){
+	if(argc != 2){
+		printf("Input error\n");
+		return 0;
+	}
+	int workers = atoi(argv[1]);
+	int eid, i;
+
+	/* doeventcreate(EVENT_TYPE_AUTORESET, 0, 0) */
+	eid = syscall(310, 2, 0, 0);
+	if(eid == -1){
+		printf("Fail in creating\n");
+		return 0;
+	}
+	printf("the event ID is %d\n", eid);
+
+	/* doeventsig with nobody waiting: stays latched for the first worker */
+	syscall(184, eid);
+
+	for(i = 0; i < workers; i++){
+		if(fork() == 0){
+			/* doeventwait */
+			syscall(183, eid);
+			printf("worker %d let through\n", getpid());
+			exit(0);
+		}
+	}
+	sleep(1);
+
+	for(i = 1; i < workers; i++){
+		/* doeventsig: exactly one more worker goes through */
+		printf("signal woke %ld\n", syscall(184, eid));
+		sleep(1);
+	}
+	for(i = 0; i < workers; i++)
+		wait(NULL);
+
+	/* doeventclose */
+	syscall(182, eid);
+	return 0;
+}
@@ -0,0 +1,43 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+/* Run given number of processes through given number of phases of a barrier event */
+int main(int argc, char **argv){
+	if(argc != 3){
+		printf("Input error\n");
+		return 0;
+	}
+	int procs = atoi(argv[1]);
+	int phases = atoi(argv[2]);
+	int eid, i, p;
+
+	/* doeventcreate(EVENT_TYPE_BARRIER, procs, 0) */
+	eid = syscall(310, 3, procs, 0);
+	if(eid == -1){
+		printf("Fail in creating\n");
+		return 0;
+	}
+	printf("the event ID is %d\n", eid);
+
+	for(i = 0; i < procs; i++){
+		if(fork() == 0){
+			for(p = 0; p < phases; p++){
+				/* stagger arrivals so the last one is the releaser */
+				usleep((i + 1) * 100000);
+				/* doeventwait: arrive and wait for the others */
+				syscall(183, eid);
+				printf("process %d passed phase %d\n", i, p);
+			}
+			exit(0);
+		}
+	}
+	for(i = 0; i < procs; i++)
+		wait(NULL);
+
+	/* doeventclose */
+	syscall(182, eid);
+	return 0;
+}
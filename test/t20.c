@@ -0,0 +1,40 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+/* Park one child per bit on an event, each interested in its own bit, then fire the given mask */
+int main(int argc, char **argv){
+	if(argc != 3){
+		printf("Input error\n");
+		return 0;
+	}
+	int children = atoi(argv[1]);
+	unsigned int fire = strtoul(argv[2], NULL, 0);
+	int eid, i;
+
+	/* creat event */
+	eid = syscall(181);
+	printf("the event ID is %d\n", eid);
+
+	for(i = 0; i < children; i++){
+		if(fork() == 0){
+			/* doeventwaitmask */
+			syscall(311, eid, 1U << i);
+			printf("child for bit %d woken\n", i);
+			exit(0);
+		}
+	}
+	sleep(1);
+
+	/* doeventsigmask */
+	printf("mask 0x%x woke %ld\n", fire, syscall(312, eid, fire));
+	sleep(1);
+
+	/* doeventclose releases the rest */
+	printf("close woke %ld\n", syscall(182, eid));
+	for(i = 0; i < children; i++)
+		wait(NULL);
+	return 0;
+}
@@ -0,0 +1,45 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+/* One child waits for all of bits 0x3 and clears them, another for any of 0x4, while the parent sets bits one at a time */
+int main(int argc, char **argv){
+	int eid;
+	long ret;
+
+	/* creat event */
+	eid = syscall(181);
+	printf("the event ID is %d\n", eid);
+
+	if(fork() == 0){
+		/* doeventflagwait(eid, 0x3, EVENT_FLAG_ALL | EVENT_FLAG_CLEAR) */
+		ret = syscall(315, eid, 0x3, 0x3);
+		printf("all of 0x3 satisfied by state 0x%lx\n", ret);
+		exit(0);
+	}
+	if(fork() == 0){
+		/* doeventflagwait(eid, 0x4, 0) */
+		ret = syscall(315, eid, 0x4, 0);
+		printf("any of 0x4 satisfied by state 0x%lx\n", ret);
+		exit(0);
+	}
+	sleep(1);
+
+	/* doeventflagset */
+	printf("set 0x1 woke %ld\n", syscall(313, eid, 0x1));
+	sleep(1);
+	printf("set 0x2 woke %ld\n", syscall(313, eid, 0x2));
+	sleep(1);
+	printf("set 0x4 woke %ld\n", syscall(313, eid, 0x4));
+	wait(NULL);
+	wait(NULL);
+
+	/* doeventflagclear: 0x3 was cleared by the first child */
+	printf("state before clear was 0x%lx\n", syscall(314, eid, ~0U));
+
+	/* doeventclose */
+	syscall(182, eid);
+	return 0;
+}
@@ -0,0 +1,44 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+/* Park given number of children on an event, then signal it with the given value */
+int main(int argc, char **argv){
+	if(argc != 3){
+		printf("Input error\n");
+		return 0;
+	}
+	int children = atoi(argv[1]);
+	uint64_t value = strtoull(argv[2], NULL, 0);
+	int eid, i;
+
+	/* creat event */
+	eid = syscall(181);
+	printf("the event ID is %d\n", eid);
+
+	for(i = 0; i < children; i++){
+		if(fork() == 0){
+			uint64_t got;
+			/* doeventwaitval */
+			if(syscall(317, eid, &got) == -1){
+				printf("Fail in waiting\n");
+				exit(1);
+			}
+			printf("child %d received %llu\n", getpid(), (unsigned long long)got);
+			exit(0);
+		}
+	}
+	sleep(1);
+
+	/* doeventsigval */
+	printf("signal woke %ld\n", syscall(316, eid, value));
+	for(i = 0; i < children; i++)
+		wait(NULL);
+
+	/* doeventclose */
+	syscall(182, eid);
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+/* Fill a mailbox event of given capacity and full policy (0 block, 1 fail, 2 overwrite) with plain signals, then send given number of messages through it */
+int main(int argc, char **argv){
+	if(argc != 4){
+		printf("Input error\n");
+		return 0;
+	}
+	int capacity = atoi(argv[1]);
+	int policy = atoi(argv[2]);
+	int messages = atoi(argv[3]);
+	int eid, i;
+	uint64_t msg;
+	long ret;
+
+	/* doeventcreate(EVENT_TYPE_MAILBOX, capacity, policy) */
+	eid = syscall(310, 4, capacity, policy);
+	if(eid == -1){
+		printf("Fail in creating\n");
+		return 0;
+	}
+	printf("the event ID is %d\n", eid);
+
+	/* doeventsign: enqueue more 0 messages than fit, which never blocks */
+	printf("sign woke %ld\n", syscall(301, eid, capacity + 1));
+	/* doeventsig: the queue is full, so this fails with EAGAIN unless the policy overwrites */
+	if(syscall(184, eid) < 0)
+		printf("sig on a full queue failed: %s\n", strerror(errno));
+	else
+		printf("sig on a full queue overwrote\n");
+
+	if(fork() == 0){
+		/* give the sender a head start to fill the queue */
+		sleep(1);
+		/* doeventwaitval: receive until the mailbox is closed and drained */
+		while(syscall(317, eid, &msg) == 0)
+			printf("received %llu\n", (unsigned long long)msg);
+		printf("receiver done: %s\n", strerror(errno));
+		exit(0);
+	}
+
+	for(i = 0; i < messages; i++){
+		/* doeventsigval */
+		ret = syscall(316, eid, (uint64_t)i);
+		if(ret < 0)
+			printf("send %d failed: %s\n", i, strerror(errno));
+	}
+	sleep(2);
+
+	/* doeventclose */
+	syscall(182, eid);
+	wait(NULL);
+	return 0;
+}
@@ -0,0 +1,69 @@
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+/* Bind an event to a shared word and pass it back and forth, entering the kernel only when someone sleeps */
+#define EVENT_WORD_SIGNALED 0x1
+#define EVENT_WORD_WAITERS  0x2
+
+static int syscalls;
+
+static void ev_set(int eid, uint32_t *word){
+	if(__sync_fetch_and_or(word, EVENT_WORD_SIGNALED) & EVENT_WORD_WAITERS){
+		/* doeventsig */
+		syscall(184, eid);
+		syscalls++;
+	}
+}
+
+static void ev_wait_reset(int eid, uint32_t *word){
+	while(!(*(volatile uint32_t *)word & EVENT_WORD_SIGNALED)){
+		/* doeventwait */
+		syscall(183, eid);
+		syscalls++;
+	}
+	__sync_fetch_and_and(word, ~EVENT_WORD_SIGNALED);
+}
+
+int main(int argc, char **argv){
+	if(argc != 2){
+		printf("Input error\n");
+		return 0;
+	}
+	int rounds = atoi(argv[1]);
+	uint32_t *words = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	int ping, pong, i;
+
+	/* creat events */
+	ping = syscall(181);
+	pong = syscall(181);
+	/* doeventbind */
+	if(syscall(318, ping, &words[0]) == -1 || syscall(318, pong, &words[1]) == -1){
+		printf("Fail in binding\n");
+		return 0;
+	}
+
+	if(fork() == 0){
+		for(i = 0; i < rounds; i++){
+			ev_wait_reset(ping, &words[0]);
+			ev_set(pong, &words[1]);
+		}
+		printf("child entered the kernel %d times\n", syscalls);
+		exit(0);
+	}
+	for(i = 0; i < rounds; i++){
+		ev_set(ping, &words[0]);
+		ev_wait_reset(pong, &words[1]);
+	}
+	wait(NULL);
+	printf("parent entered the kernel %d times in %d round trips\n", syscalls, rounds);
+
+	/* doeventclose */
+	syscall(182, ping);
+	syscall(182, pong);
+	return 0;
+}
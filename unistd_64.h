@@ -703,6 +703,51 @@ __SYSCALL(__NR_rt_tgsigqueueinfo, sys_rt_tgsigqueueinfo)
 #define __NR_perf_event_open			298
 __SYSCALL(__NR_perf_event_open, sys_perf_event_open)
 
+//eventcalls begin
+#define __NR_doeventwaitexcl			299
+__SYSCALL(__NR_doeventwaitexcl, sys_doeventwaitexcl)
+#define __NR_doeventsigone			300
+__SYSCALL(__NR_doeventsigone, sys_doeventsigone)
+#define __NR_doeventsign			301
+__SYSCALL(__NR_doeventsign, sys_doeventsign)
+#define __NR_doeventtimedwait			302
+__SYSCALL(__NR_doeventtimedwait, sys_doeventtimedwait)
+#define __NR_doeventwaitv			303
+__SYSCALL(__NR_doeventwaitv, sys_doeventwaitv)
+#define __NR_doeventwaitall			304
+__SYSCALL(__NR_doeventwaitall, sys_doeventwaitall)
+#define __NR_doeventset			305
+__SYSCALL(__NR_doeventset, sys_doeventset)
+#define __NR_doeventreset			306
+__SYSCALL(__NR_doeventreset, sys_doeventreset)
+#define __NR_doeventpulse			307
+__SYSCALL(__NR_doeventpulse, sys_doeventpulse)
+#define __NR_doeventseq			308
+__SYSCALL(__NR_doeventseq, sys_doeventseq)
+#define __NR_doeventwaitseq			309
+__SYSCALL(__NR_doeventwaitseq, sys_doeventwaitseq)
+#define __NR_doeventcreate			310
+__SYSCALL(__NR_doeventcreate, sys_doeventcreate)
+#define __NR_doeventwaitmask			311
+__SYSCALL(__NR_doeventwaitmask, sys_doeventwaitmask)
+#define __NR_doeventsigmask			312
+__SYSCALL(__NR_doeventsigmask, sys_doeventsigmask)
+#define __NR_doeventflagset			313
+__SYSCALL(__NR_doeventflagset, sys_doeventflagset)
+#define __NR_doeventflagclear			314
+__SYSCALL(__NR_doeventflagclear, sys_doeventflagclear)
+#define __NR_doeventflagwait			315
+__SYSCALL(__NR_doeventflagwait, sys_doeventflagwait)
+#define __NR_doeventsigval			316
+__SYSCALL(__NR_doeventsigval, sys_doeventsigval)
+#define __NR_doeventwaitval			317
+__SYSCALL(__NR_doeventwaitval, sys_doeventwaitval)
+#define __NR_doeventbind			318
+__SYSCALL(__NR_doeventbind, sys_doeventbind)
+#define __NR_doeventctl			319
+__SYSCALL(__NR_doeventctl, sys_doeventctl)
+//eventcalls end
+
 #ifndef __NO_STUBS
 #define __ARCH_WANT_OLD_READDIR
 #define __ARCH_WANT_OLD_STAT